@@ -0,0 +1,149 @@
+#include <bench_util.h>
+#include <net/m_net_event_loop_group.h>
+#include <net/m_socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//connections per round are kept open until the round ends, so no side is left in TIME_WAIT
+#define BENCH_ACCEPT_CONNECTION 4000
+#define BENCH_ACCEPT_ROUND      5
+#define BENCH_ACCEPT_CLIENT     4
+#define BENCH_ACCEPT_BACKLOG    4096
+#define BENCH_ACCEPT_PORT       32320
+
+static std::atomic<uint64_t> s_accepted(0);
+static std::unique_ptr<std::atomic<uint64_t>[]> s_loop_accepted;
+static MNetEventLoopGroup *s_p_group = nullptr;
+
+static void OnAccept(MNetEventLoopThread *p_loop_thread, MSocket *p_sock)
+{
+    delete p_sock;
+    s_loop_accepted[s_p_group->GetLoopIndex(p_loop_thread)].fetch_add(1, std::memory_order_relaxed);
+    s_accepted.fetch_add(1, std::memory_order_release);
+}
+
+static void OnListenerError(MNetListener *p_listener, MError err)
+{
+    printf("listener error:%d\n", static_cast<int>(err));
+}
+
+static void RunClient(unsigned short port, size_t count, std::vector<int> *p_fds)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            printf("create socket failed, errno:%d\n", errno);
+            return;
+        }
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+        {
+            printf("connect failed, errno:%d\n", errno);
+            close(fd);
+            return;
+        }
+        p_fds->push_back(fd);
+    }
+}
+
+static void CloseClient(std::vector<int> &fds)
+{
+    //reset instead of fin, nothing lingers in TIME_WAIT between rounds
+    linger lg;
+    lg.l_onoff = 1;
+    lg.l_linger = 0;
+    for (int fd : fds)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        close(fd);
+    }
+    fds.clear();
+}
+
+static void BenchAccept(size_t loop_count, unsigned short port)
+{
+    MNetEventLoopGroup group;
+    s_p_group = &group;
+    s_loop_accepted.reset(new std::atomic<uint64_t>[loop_count]);
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        s_loop_accepted[i].store(0);
+    }
+    if (group.Init(loop_count) != MError::No || group.Start() != MError::No)
+    {
+        printf("start loop group failed\n");
+        return;
+    }
+    if (group.AddListener("127.0.0.1", port, std::bind(&OnAccept, std::placeholders::_1, std::placeholders::_2)
+        , std::bind(&OnListenerError, std::placeholders::_1, std::placeholders::_2), BENCH_ACCEPT_BACKLOG) != MError::No)
+    {
+        printf("add listener failed\n");
+        return;
+    }
+    s_accepted.store(0);
+    int64_t accept_time = 0;
+    std::vector<std::vector<int> > client_fds(BENCH_ACCEPT_CLIENT);
+    for (int n = 0; n < BENCH_ACCEPT_ROUND; ++n)
+    {
+        uint64_t expect = s_accepted.load() + BENCH_ACCEPT_CONNECTION;
+        int64_t start = BenchNow();
+        std::vector<std::thread> clients;
+        for (size_t i = 0; i < BENCH_ACCEPT_CLIENT; ++i)
+        {
+            clients.push_back(std::thread(&RunClient, port, BENCH_ACCEPT_CONNECTION / BENCH_ACCEPT_CLIENT, &client_fds[i]));
+        }
+        for (auto &client : clients)
+        {
+            client.join();
+        }
+        while (s_accepted.load(std::memory_order_acquire) < expect)
+        {
+            std::this_thread::yield();
+        }
+        accept_time += BenchNow() - start;
+        for (auto &fds : client_fds)
+        {
+            CloseClient(fds);
+        }
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "accept %zu loops", loop_count);
+    BenchReport(name, s_accepted.load(), BenchNow() - accept_time);
+    uint64_t min_count = s_loop_accepted[0].load();
+    uint64_t max_count = min_count;
+    for (size_t i = 1; i < loop_count; ++i)
+    {
+        min_count = std::min(min_count, s_loop_accepted[i].load());
+        max_count = std::max(max_count, s_loop_accepted[i].load());
+    }
+    printf("%-40s %12llu min %10llu max\n", "  per loop", static_cast<unsigned long long>(min_count), static_cast<unsigned long long>(max_count));
+    group.StopAndJoin();
+    group.Close();
+    s_p_group = nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    printf("%d rounds of %d connections from %d client threads\n", BENCH_ACCEPT_ROUND, BENCH_ACCEPT_CONNECTION, BENCH_ACCEPT_CLIENT);
+    const size_t loop_counts[] = {1, 4, 16};
+    for (size_t i = 0; i < sizeof(loop_counts) / sizeof(loop_counts[0]); ++i)
+    {
+        BenchAccept(loop_counts[i], static_cast<unsigned short>(BENCH_ACCEPT_PORT + i));
+    }
+    return 0;
+}
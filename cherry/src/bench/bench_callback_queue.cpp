@@ -0,0 +1,72 @@
+#include <bench_util.h>
+#include <net/m_net_event_loop_thread.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+//every callback is added and followed by an Interrupt, as the game server posts its writes
+#define BENCH_CALLBACK_COUNT 2000000
+
+static std::atomic<uint64_t> s_ran(0);
+
+static void OnCallback(uint64_t value)
+{
+    s_ran.fetch_add(1, std::memory_order_release);
+}
+
+static void RunProducer(MNetEventLoopThread *p_loop_thread, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        p_loop_thread->AddCallback(std::bind(&OnCallback, static_cast<uint64_t>(i)));
+        p_loop_thread->Interrupt();
+    }
+}
+
+static void BenchCallbackQueue(size_t producer_count)
+{
+    MNetEventLoopThread loop_thread;
+    if (loop_thread.Init() != MError::No || loop_thread.Start() != MError::No)
+    {
+        printf("start loop thread failed\n");
+        return;
+    }
+    s_ran.store(0);
+    uint64_t wakeup_count = loop_thread.GetWakeupCount();
+    size_t count = BENCH_CALLBACK_COUNT / producer_count;
+    int64_t start = BenchNow();
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < producer_count; ++i)
+    {
+        producers.push_back(std::thread(&RunProducer, &loop_thread, count));
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    uint64_t expect = static_cast<uint64_t>(count) * producer_count;
+    while (s_ran.load(std::memory_order_acquire) < expect)
+    {
+        std::this_thread::yield();
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "AddCallback+Interrupt %zu producers", producer_count);
+    BenchReport(name, expect, start);
+    wakeup_count = loop_thread.GetWakeupCount() - wakeup_count;
+    printf("%-40s %12llu wakeups %8.2f callbacks/wakeup\n", "", static_cast<unsigned long long>(wakeup_count)
+        , wakeup_count ? static_cast<double>(expect) / wakeup_count : 0.0);
+    //closed by the destructor, a Stop after Close would interrupt a closed loop
+    loop_thread.StopAndJoin();
+}
+
+int main(int argc, char *argv[])
+{
+    printf("%d callbacks split across the producers\n", BENCH_CALLBACK_COUNT);
+    const size_t producer_counts[] = {1, 4, 8};
+    for (size_t producer_count : producer_counts)
+    {
+        BenchCallbackQueue(producer_count);
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <bench_util.h>
+#include <net/m_net_connector.h>
+#include <net/m_net_event_loop.h>
+#include <net/m_net_frame_codec.h>
+#include <net/m_socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
+
+//frames are written in batches and the loop iterates after every batch, as a game loop does
+#define BENCH_CORK_MESSAGE_LEN   100
+#define BENCH_CORK_MESSAGE_COUNT 2000000
+#define BENCH_CORK_BATCH         32
+#define BENCH_CORK_MAX_QUEUED    (1024 * 1024)
+#define BENCH_CORK_PORT          32420
+
+static void RunReceiver(int listen_fd, uint64_t total)
+{
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd == -1)
+    {
+        printf("accept failed, errno:%d\n", errno);
+        return;
+    }
+    char buf[65536];
+    uint64_t received = 0;
+    while (received < total)
+    {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+            printf("recv failed, errno:%d\n", errno);
+            break;
+        }
+        received += static_cast<uint64_t>(n);
+    }
+    close(fd);
+}
+
+static int CreateListener(unsigned short port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(fd, 16) == -1)
+    {
+        printf("listen on %u failed, errno:%d\n", port, errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int Connect(unsigned short port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+    {
+        printf("connect failed, errno:%d\n", errno);
+        close(fd);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+static void BenchCork(bool cork, unsigned short port)
+{
+    int listen_fd = CreateListener(port);
+    if (listen_fd == -1)
+    {
+        return;
+    }
+    //the default codec puts a 2 byte Fixed16 header on every frame
+    uint64_t total = static_cast<uint64_t>(BENCH_CORK_MESSAGE_COUNT) * (BENCH_CORK_MESSAGE_LEN + 2);
+    std::thread receiver(&RunReceiver, listen_fd, total);
+    int fd = Connect(port);
+    if (fd == -1)
+    {
+        receiver.detach();
+        return;
+    }
+    MNetEventLoop loop;
+    loop.Create();
+    MSocket *p_sock = new MSocket(fd);
+    p_sock->SetBlock(false);
+    MNetConnector *p_connector = new MNetConnector(p_sock, &loop, nullptr, nullptr, nullptr, nullptr, true, 0, 0);
+    p_connector->EnableReadWrite(true);
+    p_connector->SetCork(cork);
+    MNetFrameCodec codec;
+    char message[BENCH_CORK_MESSAGE_LEN];
+    memset(message, 'x', sizeof(message));
+    int64_t start = BenchNow();
+    for (int n = 0; n < BENCH_CORK_MESSAGE_COUNT; n += BENCH_CORK_BATCH)
+    {
+        for (int i = 0; i < BENCH_CORK_BATCH; ++i)
+        {
+            codec.Write(p_connector, message, sizeof(message));
+        }
+        //one iteration flushes the corked batch, more wait for the socket to drain
+        loop.Interrupt();
+        loop.ProcessEvents();
+        while (p_connector->GetWriteBufLen() > BENCH_CORK_MAX_QUEUED)
+        {
+            loop.ProcessEvents();
+        }
+    }
+    while (p_connector->GetWriteBufLen() > 0)
+    {
+        loop.Interrupt();
+        loop.ProcessEvents();
+    }
+    receiver.join();
+    BenchReport(cork ? "100 byte frames corked" : "100 byte frames uncorked", BENCH_CORK_MESSAGE_COUNT, start);
+    p_connector->EnableReadWrite(false);
+    delete p_connector;
+    loop.Close();
+    close(listen_fd);
+}
+
+int main(int argc, char *argv[])
+{
+    printf("%d frames of %d bytes over tcp loopback, %d per loop iteration, TCP_NODELAY\n"
+        , BENCH_CORK_MESSAGE_COUNT, BENCH_CORK_MESSAGE_LEN, BENCH_CORK_BATCH);
+    BenchCork(false, BENCH_CORK_PORT);
+    BenchCork(true, BENCH_CORK_PORT + 1);
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <bench_util.h>
+#include <event/m_event_loop.h>
+#include <event/m_event_base.h>
+#include <list>
+#include <memory>
+
+//every iteration re-arms this many before events, as a busy loop does with per-connection hooks
+#define BENCH_HOOK_COUNT     10000
+#define BENCH_HOOK_ITERATION 1000
+
+static uint64_t s_fired = 0;
+
+class BenchHookEvent
+    :public MBeforeEventBase
+{
+public:
+    void SetLoop(MEventLoop *p_event_loop)
+    {
+        p_loop_ = p_event_loop;
+    }
+private:
+    virtual void _OnCallback() override
+    {
+        ++s_fired;
+        p_loop_->AddBeforeEvent(this);
+    }
+private:
+    MEventLoop *p_loop_ = nullptr;
+};
+
+//the std::list queue MEventLoop used before the intrusive hooks, one list node per arm
+struct BenchListEvent;
+typedef std::list<BenchListEvent*> BenchEventList;
+
+struct BenchListEvent
+{
+    BenchEventList::iterator location;
+    bool actived = false;
+};
+
+static void ListAdd(BenchEventList &events, BenchListEvent *p_event)
+{
+    if (p_event->actived)
+    {
+        return;
+    }
+    events.push_back(p_event);
+    auto iter = events.end();
+    p_event->location = --iter;
+    p_event->actived = true;
+}
+
+static void ListDel(BenchEventList &events, BenchListEvent *p_event)
+{
+    if (!p_event->actived)
+    {
+        return;
+    }
+    events.erase(p_event->location);
+    p_event->actived = false;
+}
+
+static void BenchHook()
+{
+    MEventLoop loop;
+    if (loop.Init() != MError::No)
+    {
+        printf("MEventLoop Init failed\n");
+        return;
+    }
+    std::unique_ptr<BenchHookEvent[]> events(new BenchHookEvent[BENCH_HOOK_COUNT]);
+    for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+    {
+        events[i].Init(&loop);
+        events[i].SetLoop(&loop);
+    }
+    int64_t start = BenchNow();
+    for (int n = 0; n < BENCH_HOOK_ITERATION; ++n)
+    {
+        for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+        {
+            loop.AddBeforeEvent(&events[i]);
+        }
+        for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+        {
+            loop.DelBeforeEvent(&events[i]);
+        }
+    }
+    BenchReport("hook arm+disarm", static_cast<uint64_t>(BENCH_HOOK_COUNT) * BENCH_HOOK_ITERATION, start);
+    for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+    {
+        loop.AddBeforeEvent(&events[i]);
+    }
+    s_fired = 0;
+    start = BenchNow();
+    for (int n = 0; n < BENCH_HOOK_ITERATION; ++n)
+    {
+        loop.DispatchEventOnce(0);
+    }
+    BenchReport("hook dispatch+re-arm", s_fired, start);
+    for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+    {
+        loop.DelBeforeEvent(&events[i]);
+    }
+}
+
+static void BenchList()
+{
+    BenchEventList before_events;
+    std::unique_ptr<BenchListEvent[]> events(new BenchListEvent[BENCH_HOOK_COUNT]);
+    int64_t start = BenchNow();
+    for (int n = 0; n < BENCH_HOOK_ITERATION; ++n)
+    {
+        for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+        {
+            ListAdd(before_events, &events[i]);
+        }
+        for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+        {
+            ListDel(before_events, &events[i]);
+        }
+    }
+    BenchReport("std::list arm+disarm", static_cast<uint64_t>(BENCH_HOOK_COUNT) * BENCH_HOOK_ITERATION, start);
+    for (int i = 0; i < BENCH_HOOK_COUNT; ++i)
+    {
+        ListAdd(before_events, &events[i]);
+    }
+    s_fired = 0;
+    start = BenchNow();
+    for (int n = 0; n < BENCH_HOOK_ITERATION; ++n)
+    {
+        BenchEventList pending;
+        pending.swap(before_events);
+        for (auto p_event : pending)
+        {
+            p_event->actived = false;
+            ++s_fired;
+            ListAdd(before_events, p_event);
+        }
+    }
+    BenchReport("std::list dispatch+re-arm", s_fired, start);
+}
+
+int main(int argc, char *argv[])
+{
+    printf("%d hooks x %d iterations\n", BENCH_HOOK_COUNT, BENCH_HOOK_ITERATION);
+    BenchHook();
+    BenchList();
+    return 0;
+}
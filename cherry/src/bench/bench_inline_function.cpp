@@ -0,0 +1,120 @@
+#include <bench_util.h>
+#include <event/m_event_loop.h>
+#include <util/m_inline_function.h>
+#include <util/m_mpsc_queue.h>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+//tasks are posted in batches and then run, as a loop drains its queue once per wakeup
+#define BENCH_POST_BATCH     1000
+#define BENCH_POST_ITERATION 2000
+
+static std::atomic<uint64_t> s_alloc_count(0);
+
+void* operator new(size_t size)
+{
+    s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept
+{
+    free(p);
+}
+
+static uint64_t s_ran = 0;
+
+//the shape of the game server's OnWriteSessionCallback bind, a member function plus three arguments
+class BenchSession
+{
+public:
+    void OnWrite(uint64_t id, char *p_buf, size_t len)
+    {
+        s_ran += id + len + (p_buf ? 1 : 0);
+    }
+};
+
+static void BenchReportAlloc(const char *p_name, uint64_t ops, int64_t start_nano_time, uint64_t start_alloc_count)
+{
+    BenchReport(p_name, ops, start_nano_time);
+    printf("%-40s %12.2f allocs/op\n", "", static_cast<double>(s_alloc_count.load() - start_alloc_count) / ops);
+}
+
+template<typename F>
+static void BenchQueue(const char *p_name)
+{
+    BenchSession session;
+    char buf[16];
+    MMpscQueue<F> queue;
+    F task;
+    //warm the queue's node cache
+    for (int i = 0; i < BENCH_POST_BATCH; ++i)
+    {
+        queue.Push(F(std::bind(&BenchSession::OnWrite, &session, static_cast<uint64_t>(i), buf, sizeof(buf))));
+    }
+    while (queue.Pop(task))
+    {
+        task();
+    }
+    uint64_t alloc_count = s_alloc_count.load();
+    int64_t start = BenchNow();
+    for (int n = 0; n < BENCH_POST_ITERATION; ++n)
+    {
+        for (int i = 0; i < BENCH_POST_BATCH; ++i)
+        {
+            queue.Push(F(std::bind(&BenchSession::OnWrite, &session, static_cast<uint64_t>(i), buf, sizeof(buf))));
+        }
+        while (queue.Pop(task))
+        {
+            task();
+        }
+    }
+    BenchReportAlloc(p_name, static_cast<uint64_t>(BENCH_POST_BATCH) * BENCH_POST_ITERATION, start, alloc_count);
+}
+
+static void BenchLoopPost()
+{
+    MEventLoop loop;
+    if (loop.Init() != MError::No)
+    {
+        printf("MEventLoop Init failed\n");
+        return;
+    }
+    BenchSession session;
+    char buf[16];
+    loop.Post(std::bind(&BenchSession::OnWrite, &session, static_cast<uint64_t>(0), buf, sizeof(buf)));
+    loop.DispatchEventOnce(0);
+    uint64_t alloc_count = s_alloc_count.load();
+    int64_t start = BenchNow();
+    for (int n = 0; n < BENCH_POST_ITERATION; ++n)
+    {
+        for (int i = 0; i < BENCH_POST_BATCH; ++i)
+        {
+            loop.Post(std::bind(&BenchSession::OnWrite, &session, static_cast<uint64_t>(i), buf, sizeof(buf)));
+        }
+        loop.DispatchEventOnce(0);
+    }
+    BenchReportAlloc("MEventLoop Post+dispatch", static_cast<uint64_t>(BENCH_POST_BATCH) * BENCH_POST_ITERATION, start, alloc_count);
+}
+
+int main(int argc, char *argv[])
+{
+    printf("%d batches of %d posted binds\n", BENCH_POST_ITERATION, BENCH_POST_BATCH);
+    BenchQueue<MInlineFunction<void ()> >("MInlineFunction push+run");
+    BenchQueue<std::function<void ()> >("std::function push+run");
+    BenchLoopPost();
+    printf("checksum %llu\n", static_cast<unsigned long long>(s_ran));
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <bench_util.h>
+#include <event/m_event_loop.h>
+#include <event/m_event_base.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+//each round makes this many of the registered fds readable and dispatches until all are handled
+#define BENCH_IO_ACTIVE_COUNT 1000
+#define BENCH_IO_ROUND        200
+
+static uint64_t s_fired = 0;
+
+class BenchIOEvent
+    :public MIOEventBase
+{
+private:
+    virtual void _OnCallback(unsigned events) override
+    {
+        uint64_t count = 0;
+        if (read(GetFD(), &count, sizeof(count)) > 0)
+        {
+            ++s_fired;
+        }
+    }
+};
+
+static const char* GetBackendName(MEventLoopBackend backend)
+{
+    return backend == MEventLoopBackend::IOUring ? "io_uring" : "epoll";
+}
+
+static void BenchBackend(MEventLoopBackend backend, unsigned mode, size_t count)
+{
+    MEventLoop loop;
+    if (loop.Init(backend) != MError::No)
+    {
+        printf("MEventLoop Init failed\n");
+        return;
+    }
+    if (loop.GetBackend() != backend)
+    {
+        printf("%s not supported, skipped\n", GetBackendName(backend));
+        return;
+    }
+    std::vector<int> fds(count, -1);
+    std::unique_ptr<BenchIOEvent[]> events(new BenchIOEvent[count]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fds[i] == -1 || events[i].Init(&loop, fds[i]) != MError::No)
+        {
+            printf("create eventfd %zu failed\n", i);
+            count = i;
+            break;
+        }
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "%s %s %zu register", GetBackendName(backend), mode & MIOEVENT_ET ? "et" : "lt", count);
+    int64_t start = BenchNow();
+    for (size_t i = 0; i < count; ++i)
+    {
+        events[i].EnableEvent(mode);
+    }
+    //io_uring submits interest changes with the next wait
+    loop.DispatchEventOnce(0);
+    BenchReport(name, count, start);
+    std::mt19937 rng(static_cast<unsigned>(count));
+    std::uniform_int_distribution<size_t> dist(0, count - 1);
+    std::vector<size_t> actives;
+    std::vector<char> picked(count, 0);
+    uint64_t one = 1;
+    int64_t dispatch_time = 0;
+    s_fired = 0;
+    for (int n = 0; n < BENCH_IO_ROUND; ++n)
+    {
+        actives.clear();
+        while (actives.size() < BENCH_IO_ACTIVE_COUNT)
+        {
+            size_t index = dist(rng);
+            if (!picked[index])
+            {
+                picked[index] = 1;
+                actives.push_back(index);
+            }
+        }
+        for (size_t index : actives)
+        {
+            picked[index] = 0;
+            if (write(fds[index], &one, sizeof(one)) != sizeof(one))
+            {
+                printf("write eventfd failed\n");
+                return;
+            }
+        }
+        uint64_t expect = s_fired + actives.size();
+        start = BenchNow();
+        while (s_fired < expect)
+        {
+            uint64_t fired = s_fired;
+            loop.DispatchEventOnce(0);
+            if (s_fired == fired)
+            {
+                break;
+            }
+        }
+        dispatch_time += BenchNow() - start;
+    }
+    snprintf(name, sizeof(name), "%s %s %zu dispatch", GetBackendName(backend), mode & MIOEVENT_ET ? "et" : "lt", count);
+    BenchReport(name, s_fired, BenchNow() - dispatch_time);
+    for (size_t i = 0; i < count; ++i)
+    {
+        events[i].Clear();
+        close(fds[i]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    const size_t counts[] = {10000, 50000, 100000};
+    for (size_t count : counts)
+    {
+        //leave room for the loop's own fds
+        if (count + 64 > limit.rlim_cur)
+        {
+            printf("%zu fds skipped, RLIMIT_NOFILE is %llu\n", count, static_cast<unsigned long long>(limit.rlim_cur));
+            continue;
+        }
+        const unsigned modes[] = {MIOEVENT_IN, MIOEVENT_IN | MIOEVENT_ET};
+        for (unsigned mode : modes)
+        {
+            BenchBackend(MEventLoopBackend::Epoll, mode, count);
+            BenchBackend(MEventLoopBackend::IOUring, mode, count);
+        }
+    }
+    return 0;
+}
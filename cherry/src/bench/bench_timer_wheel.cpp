@@ -0,0 +1,142 @@
+#include <bench_util.h>
+#include <event/m_event_loop.h>
+#include <event/m_event_base.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+//1M timers spread over two root wheel turns, so expiry also cascades level 0
+#define BENCH_TIMER_COUNT  1000000
+#define BENCH_TIMER_SPREAD 2048
+
+static uint64_t s_fired = 0;
+
+class BenchWheelTimer
+    :public MTimerEventBase
+{
+private:
+    virtual void _OnCallback() override
+    {
+        ++s_fired;
+    }
+};
+
+//the queue MEventLoop used before the wheel, one multimap node per timer
+struct BenchMapTimer;
+typedef std::multimap<int64_t, BenchMapTimer*> BenchTimerMap;
+
+struct BenchMapTimer
+{
+    BenchTimerMap::iterator location;
+    bool actived = false;
+};
+
+static void BenchWheel(const std::vector<int64_t> &offsets, const std::vector<int64_t> &rearm_offsets)
+{
+    MEventLoop loop;
+    if (loop.Init() != MError::No)
+    {
+        printf("MEventLoop Init failed\n");
+        return;
+    }
+    size_t count = offsets.size();
+    std::unique_ptr<BenchWheelTimer[]> timers(new BenchWheelTimer[count]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        timers[i].Init(&loop);
+    }
+    s_fired = 0;
+    int64_t base = loop.GetTime();
+    int64_t start = BenchNow();
+    for (size_t i = 0; i < count; ++i)
+    {
+        loop.AddTimerEvent(base + offsets[i], &timers[i]);
+    }
+    BenchReport("wheel add", count, start);
+    start = BenchNow();
+    for (size_t i = 0; i < count; i += 2)
+    {
+        loop.DelTimerEvent(&timers[i]);
+    }
+    BenchReport("wheel cancel", count / 2, start);
+    start = BenchNow();
+    for (size_t i = 0; i < count; i += 2)
+    {
+        loop.AddTimerEvent(base + rearm_offsets[i], &timers[i]);
+    }
+    BenchReport("wheel re-arm", count / 2, start);
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_TIMER_SPREAD + 10));
+    start = BenchNow();
+    while (s_fired < count)
+    {
+        if (loop.DispatchEventOnce(0) != MError::No)
+        {
+            printf("DispatchEventOnce failed\n");
+            return;
+        }
+    }
+    BenchReport("wheel expire", count, start);
+}
+
+static void BenchMultimap(const std::vector<int64_t> &offsets, const std::vector<int64_t> &rearm_offsets)
+{
+    BenchTimerMap timer_map;
+    size_t count = offsets.size();
+    std::unique_ptr<BenchMapTimer[]> timers(new BenchMapTimer[count]);
+    s_fired = 0;
+    int64_t base = MTime::GetMonotonicTime();
+    int64_t start = BenchNow();
+    for (size_t i = 0; i < count; ++i)
+    {
+        timers[i].location = timer_map.insert(std::make_pair(base + offsets[i], &timers[i]));
+        timers[i].actived = true;
+    }
+    BenchReport("multimap add", count, start);
+    start = BenchNow();
+    for (size_t i = 0; i < count; i += 2)
+    {
+        timer_map.erase(timers[i].location);
+        timers[i].actived = false;
+    }
+    BenchReport("multimap cancel", count / 2, start);
+    start = BenchNow();
+    for (size_t i = 0; i < count; i += 2)
+    {
+        timers[i].location = timer_map.insert(std::make_pair(base + rearm_offsets[i], &timers[i]));
+        timers[i].actived = true;
+    }
+    BenchReport("multimap re-arm", count / 2, start);
+    std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_TIMER_SPREAD + 10));
+    start = BenchNow();
+    int64_t now = MTime::GetMonotonicTime();
+    auto it = timer_map.begin();
+    while (it != timer_map.end() && it->first <= now)
+    {
+        BenchMapTimer *p_timer = it->second;
+        timer_map.erase(it);
+        p_timer->actived = false;
+        ++s_fired;
+        it = timer_map.begin();
+    }
+    BenchReport("multimap expire", count, start);
+}
+
+int main(int argc, char *argv[])
+{
+    std::mt19937_64 rng(20160528);
+    std::uniform_int_distribution<int64_t> dist(1, BENCH_TIMER_SPREAD);
+    std::vector<int64_t> offsets(BENCH_TIMER_COUNT);
+    std::vector<int64_t> rearm_offsets(BENCH_TIMER_COUNT);
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        offsets[i] = dist(rng);
+        rearm_offsets[i] = dist(rng);
+    }
+    printf("%d timers over %d ms\n", BENCH_TIMER_COUNT, BENCH_TIMER_SPREAD);
+    BenchWheel(offsets, rearm_offsets);
+    BenchMultimap(offsets, rearm_offsets);
+    return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef _BENCH_UTIL_H_
+#define _BENCH_UTIL_H_
+
+#include <util/m_time.h>
+#include <util/m_type_define.h>
+#include <cstdio>
+
+inline int64_t BenchNow()
+{
+    return MTime::GetMonotonicNanoTime();
+}
+
+//prints ns per op and million ops per second for ops done since start_nano_time
+inline void BenchReport(const char *p_name, uint64_t ops, int64_t start_nano_time)
+{
+    int64_t nano_time = BenchNow() - start_nano_time;
+    if (ops == 0 || nano_time <= 0)
+    {
+        printf("%-40s %12s\n", p_name, "-");
+        return;
+    }
+    printf("%-40s %12.1f ns/op %10.2f Mops/s\n", p_name
+        , static_cast<double>(nano_time) / ops
+        , static_cast<double>(ops) * 1000.0 / nano_time);
+}
+
+#endif
@@ -0,0 +1,6 @@
+#!/bin/bash
+BUILD_PATH=../../build/bench
+if [ ! -d $BUILD_PATH ]; then
+    mkdir -p $BUILD_PATH 1>/dev/null 2>&1 || echo "failed to created dir ${BUILD_PATH}"
+fi
+cd ../../build/bench && cmake -DCMAKE_BUILD_TYPE=Release ../../src/bench && make
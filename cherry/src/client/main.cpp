@@ -1,12 +1,12 @@
 #include <net/m_net_event_loop_thread.h>
 #include <net/m_net_connector.h>
+#include <net/m_net_frame_codec.h>
 #include <net/m_net_listener.h>
 #include <util/m_logger.h>
 #include <arpa/inet.h>
 #include <net/m_socket.h>
 
-uint16_t len = 0;
-bool len_readed = false;
+MNetFrameCodec codec;
 
 void OnConnectCallback(MNetConnector *p_connector)
 {
@@ -21,34 +21,19 @@ void OnErrorCallback(MError err)
 
 void OnReadCallback(MNetConnector *p_connector)
 {
-    while (true)
+    MError err = codec.Decode(p_connector);
+    if (err != MError::No)
     {
-        if (!len_readed)
-        {
-            if (p_connector->ReadBuf(&len, sizeof(len)) == MError::No)
-            {
-                len = ntohs(len);
-                len_readed = true;
-            }
-            else
-            {
-                return;
-            }
-        }
-        std::string str;
-        str.resize(len);
-        if (p_connector->ReadBuf(&str[0], str.size()) == MError::No)
-        {
-            MLOG(MGetLibLogger(), MWARN, str);
-            len_readed = false;
-        }
-        else
-        {
-            return;
-        }
+        MLOG(MGetLibLogger(), MERR, "decode failed err:", static_cast<int>(err));
+        p_connector->EnableReadWrite(false);
     }
 }
 
+void OnMessageCallback(const char *p_buf, size_t len)
+{
+    MLOG(MGetLibLogger(), MWARN, std::string(p_buf, len));
+}
+
 void OnWriteCompleteCallback(MNetConnector *p_connector)
 {
     MLOG(MGetLibLogger(), MERR, "write complete");
@@ -56,9 +41,7 @@ void OnWriteCompleteCallback(MNetConnector *p_connector)
 
 void WriteTo(MNetConnector *p_connector, const std::string &str)
 {
-    uint16_t size = htons(static_cast<uint16_t>(str.size()));
-    p_connector->WriteBuf(static_cast<const char*>(static_cast<void *>(&size)), sizeof(size));
-    p_connector->WriteBuf(str.c_str(), str.size());
+    codec.Write(p_connector, str.c_str(), str.size());
 }
 
 int main (int argc, char *argv[])
@@ -83,7 +66,8 @@ int main (int argc, char *argv[])
         MLOG(MGetLibLogger(), MERR, "create socket failed");
         return 0;
     }
-    MNetConnector conn(&sock, nullptr, &ev_thread.GetEventLoop(), nullptr, nullptr, nullptr, nullptr, false, 10, 10);
+    MNetConnector conn(&sock, &ev_thread.GetEventLoop(), nullptr, nullptr, nullptr, nullptr, false, 0, 0);
+    codec.SetMessageCallback(std::bind(OnMessageCallback, std::placeholders::_1, std::placeholders::_2));
     conn.SetConnectCallback(std::bind(OnConnectCallback, &conn));
     conn.SetReadCallback(std::bind(OnReadCallback, &conn));
     conn.SetWriteCompleteCallback(std::bind(OnWriteCompleteCallback, &conn));
@@ -108,7 +92,7 @@ int main (int argc, char *argv[])
         ev_thread.AddCallback(std::bind(WriteTo, &conn, str));
         ev_thread.Interrupt();
     }
-    ev_thread.Join();
+    ev_thread.StopAndJoin();
     MLOG(MGetLibLogger(), MERR, "exit...");
     return 0;
 }
@@ -3,6 +3,16 @@
 #include <cstring>
 #include <util/m_logger.h>
 
+void* NetSession::operator new(size_t size)
+{
+    return MObjectPool<NetSession>::Alloc(size);
+}
+
+void NetSession::operator delete(void *p, size_t size)
+{
+    MObjectPool<NetSession>::Free(p, size);
+}
+
 NetManager::NetManager()
 {
 }
@@ -14,64 +24,51 @@ NetManager::~NetManager()
 
 bool NetManager::Init(size_t work_count)
 {
-    work_list_.resize(work_count);
-    for (auto &work : work_list_)
+    //session ids carry the loop index as their slot map owner
+    if (work_count == 0 || work_count > MSLOT_MAP_MAX_OWNER + 1)
+    {
+        MLOG(MGetLibLogger(), MERR, "invalid loop count:", work_count);
+        return false;
+    }
+    if (loop_group_.Init(work_count) != MError::No
+        || loop_group_.Start() != MError::No)
+    {
+        return false;
+    }
+    std::vector<MSlotMap<NetSession*> >(loop_group_.GetLoopCount()).swap(loop_session_list_);
+    for (size_t i = 0; i < loop_group_.GetLoopCount(); ++i)
     {
-        work = new MNetEventLoopThread();
-        if (!work
-            || work->Init() != MError::No
-            || work->Start() != MError::No)
+        loop_session_list_[i].Init(static_cast<uint8_t>(i));
+        if (watchdog_.AddLoop(loop_group_.GetLoopThread(i)) != MError::No)
         {
             return false;
         }
     }
-    return true;
+    return watchdog_.Start(NET_LOOP_STALL_TIME) == MError::No;
 }
 
 void NetManager::Close()
 {
-    for (const auto &work : work_list_)
-    {
-        delete work;
-    }
-    for (const auto &listener : listener_list_)
+    watchdog_.StopAndJoin();
+    loop_group_.StopAndJoin();
+    for (auto &session_list : loop_session_list_)
     {
-        delete listener;
-    }
-    for (const auto &session : session_list_)
-    {
-        if (session && session->p_connector)
+        for (auto &p_session : session_list)
         {
-            delete session->p_connector;
+            delete p_session->p_connector;
+            delete p_session;
         }
-        delete session;
     }
+    loop_session_list_.clear();
+    loop_group_.Close();
 }
 
 bool NetManager::AddListener(const std::string &ip, unsigned short port)
 {
-    MSocket *p_sock = new MSocket();
-    if (!p_sock)
-    {
-        return false;
-    }
-    if (p_sock->CreateNonblockReuseAddrListener(ip, port, 128) != MError::No)
-    {
-        delete p_sock;
-        return false;
-    }
-    MNetEventLoopThread *p_net_thread = GetMinEventsThread();
-    MNetListener *p_listener = new MNetListener(p_sock, &(p_net_thread->GetEventLoop()), nullptr, nullptr, true, 5);
-    if (!p_listener)
-    {
-        return false;
-    }
-    listener_list_.push_back(p_listener);
-
-    p_listener->SetAcceptCallback(std::bind(&NetManager::OnConnectCallback, this, p_listener, std::placeholders::_1));
-    p_listener->SetErrorCallback(std::bind(&NetManager::OnListenerErrorCallback, this, listener_list_.size()-1, std::placeholders::_1));
-
-    MError err = p_listener->EnableAccept(true);
+    MError err = loop_group_.AddListener(ip, port
+        , std::bind(&NetManager::OnConnectCallback, this, std::placeholders::_1, std::placeholders::_2)
+        , std::bind(&NetManager::OnListenerErrorCallback, this, std::placeholders::_1, std::placeholders::_2)
+        , 128, 5);
     if (err != MError::No)
     {
         return false;
@@ -79,131 +76,133 @@ bool NetManager::AddListener(const std::string &ip, unsigned short port)
     return true;
 }
 
-void OnCloseSessionCallback(NetSession *p_session)
+void NetManager::OnCloseSessionCallback(uint64_t id)
 {
-    if (p_session)
+    MSlotMap<NetSession*> &session_list = loop_session_list_[MSlotMap<NetSession*>::GetOwner(id)];
+    NetSession **pp_session = session_list.Get(id);
+    if (!pp_session)
     {
-        if (p_session->p_connector)
-        {
-            delete p_session->p_connector;
-        }
-        delete p_session;
+        return;
     }
+    NetSession *p_session = *pp_session;
+    session_list.Remove(id);
+    delete p_session->p_connector;
+    delete p_session;
 }
 
-void NetManager::CloseSession(NetSession *p_session)
+void NetManager::CloseSession(uint64_t id)
 {
-    if (!p_session)
+    MNetEventLoopThread *p_loop_thread = loop_group_.GetLoopThread(MSlotMap<NetSession*>::GetOwner(id));
+    if (!p_loop_thread)
     {
         return;
     }
+    p_loop_thread->AddCallback(std::bind(&NetManager::OnCloseSessionCallback, this, id));
+    p_loop_thread->Interrupt();
+}
+
+void NetManager::OnWriteSessionCallback(uint64_t id, char *p_buf, size_t len)
+{
+    NetSession **pp_session = loop_session_list_[MSlotMap<NetSession*>::GetOwner(id)].Get(id);
+    if (pp_session)
     {
-        std::lock_guard<std::mutex> lock(session_mutex_);
-        auto it = session_list_.find(p_session);
-        if (it != session_list_.end())
-        {
-            session_list_.erase(it);
-        }
-    }
-    if (p_session->p_loop_thread)
-    {
-        p_session->p_loop_thread->AddCallback(std::bind(OnCloseSessionCallback, p_session));
-    }
-    else
-    {
-        delete p_session;
+        (*pp_session)->codec.Write((*pp_session)->p_connector, p_buf, len);
     }
+    delete[] p_buf;
 }
 
-void OnWriteSessionCallback(NetSession *p_session, char *p_buf, size_t len)
+void NetManager::WriteSession(uint64_t id, char *p_buf, size_t len)
 {
-    uint16_t size = htons(static_cast<uint16_t>(len));
-    p_session->p_connector->WriteBuf(static_cast<char*>(static_cast<void*>(&size)), sizeof(size));
-    p_session->p_connector->WriteBuf(p_buf, len);
-    delete p_buf;
+    MNetEventLoopThread *p_loop_thread = loop_group_.GetLoopThread(MSlotMap<NetSession*>::GetOwner(id));
+    if (!p_loop_thread)
+    {
+        delete[] p_buf;
+        return;
+    }
+    p_loop_thread->AddCallback(std::bind(&NetManager::OnWriteSessionCallback, this, id, p_buf, len));
+    p_loop_thread->Interrupt();
 }
 
-void NetManager::WriteSession(NetSession *p_session, char *p_buf, size_t len)
+void NetManager::WriteAll(const char *p_buf, size_t len)
 {
-    if (!p_session)
+    if (len > frame_codec_.GetMaxLen())
     {
+        MLOG(MGetLibLogger(), MERR, "broadcast len:", len, " max len:", frame_codec_.GetMaxLen());
         return;
     }
-    p_session->p_loop_thread->AddCallback(std::bind(OnWriteSessionCallback, p_session, p_buf, len));
-    p_session->p_loop_thread->Interrupt();
+    char header[MNET_FRAME_MAX_HEADER_LEN];
+    size_t header_len = frame_codec_.EncodeHeader(len, header);
+    MSharedBuffer frame(header_len + len);
+    memcpy(frame.GetWriteData(), header, header_len);
+    memcpy(frame.GetWriteData() + header_len, p_buf, len);
+    Broadcast(frame);
 }
 
-void NetManager::WriteAll(const char *p_buf, size_t len)
+void NetManager::Broadcast(const MSharedBuffer &frame)
 {
-    std::lock_guard<std::mutex> lock(session_mutex_);
-    for (auto &it : session_list_)
+    for (size_t i = 0; i < loop_group_.GetLoopCount(); ++i)
     {
-        char *p_tmp = new char[len];
-        memcpy(p_tmp, p_buf, len);
-        WriteSession(it, p_tmp, len);
+        MNetEventLoopThread *p_loop_thread = loop_group_.GetLoopThread(i);
+        p_loop_thread->AddCallback(std::bind(&NetManager::OnBroadcastCallback, this, i, frame));
+        p_loop_thread->Interrupt();
     }
 }
 
-void NetManager::OnReadCallback(NetSession *p_session)
+void NetManager::OnBroadcastCallback(size_t loop_index, const MSharedBuffer &frame)
 {
-    while (true)
+    for (auto p_session : loop_session_list_[loop_index])
     {
-        if (!p_session->len_readed)
-        {
-            if (p_session->p_connector->ReadBuf(&p_session->len, sizeof(p_session->len)) == MError::No)
-            {
-                p_session->len = ntohs(p_session->len);
-                p_session->len_readed = true;
-            }
-            else
-            {
-                return;
-            }
-        }
-        std::string str;
-        str.resize(p_session->len);
-        if (p_session->p_connector->ReadBuf(&str[0], str.size()) == MError::No)
+        if (p_session->write_paused.load(std::memory_order_relaxed))
         {
-            p_session->len_readed = false;
-            std::cout << p_session->p_connector->GetSocket()->GetRemoteIP() << " "
-            << p_session->p_connector->GetSocket()->GetRemotePort() << " "
-                << str << std::endl;
-        }
-        else
-        {
-            return;
+            continue;
         }
+        p_session->p_connector->WriteBuf(frame);
+    }
+}
+
+void NetManager::OnReadCallback(NetSession *p_session)
+{
+    MError err = p_session->codec.Decode(p_session->p_connector);
+    if (err != MError::No)
+    {
+        p_session->p_connector->OnErrorCallback(err);
     }
 }
 
+void NetManager::OnMessageCallback(NetSession *p_session, const char *p_buf, size_t len)
+{
+    std::cout << p_session->p_connector->GetSocket()->GetRemoteIP() << " "
+        << p_session->p_connector->GetSocket()->GetRemotePort() << " ";
+    std::cout.write(p_buf, len) << std::endl;
+}
+
 void NetManager::OnCloseCallback(NetSession *p_session, MError err)
 {
     std::cout << p_session->p_connector->GetSocket()->GetRemoteIP() << " "
         << p_session->p_connector->GetSocket()->GetRemotePort() << " "
         << " has socket disconnect:" << static_cast<int>(err) << std::endl;
-    std::lock_guard<std::mutex> lock(session_mutex_);
-    auto it = session_list_.find(p_session);
-    if (it != session_list_.end())
-    {
-        session_list_.erase(it);
-    }
+    loop_session_list_[p_session->loop_index].Remove(p_session->id);
     delete p_session->p_connector;
     delete p_session;
 }
 
-void NetManager::OnConnectCallback(MNetListener *p_listener, MSocket *p_sock)
+void OnSessionWaterCallback(NetSession *p_session, bool paused)
+{
+    p_session->write_paused = paused;
+}
+
+void NetManager::OnConnectCallback(MNetEventLoopThread *p_loop_thread, MSocket *p_sock)
 {
     if (!p_sock)
     {
         return;
     }
-    MNetEventLoopThread *p_loop_thread = GetMinEventsThread();
     if (!p_loop_thread)
     {
         delete p_sock;
         return;
     }
-    MNetConnector *p_connector = new MNetConnector(p_sock, p_listener, &(p_loop_thread->GetEventLoop()), nullptr, nullptr, nullptr, nullptr, true, 1024, 1024);
+    MNetConnector *p_connector = new MNetConnector(p_sock, &(p_loop_thread->GetEventLoop()), nullptr, nullptr, nullptr, nullptr, true, NET_SESSION_READ_BUF_LEN, NET_SESSION_WRITE_BUF_LEN);
     if (!p_connector)
     {
         delete p_sock;
@@ -212,50 +211,39 @@ void NetManager::OnConnectCallback(MNetListener *p_listener, MSocket *p_sock)
     NetSession *p_session = new NetSession();
     p_session->p_connector = p_connector;
     p_session->p_loop_thread = p_loop_thread;
-    p_session->len_readed = false;
-    p_session->len = 0;
-
-    std::lock_guard<std::mutex> lock(session_mutex_);
-    session_list_.insert(p_session);
+    p_session->loop_index = loop_group_.GetLoopIndex(p_loop_thread);
+    p_session->write_paused = false;
+    p_session->id = loop_session_list_[p_session->loop_index].Insert(p_session);
+    if (p_session->id == MSLOT_MAP_INVALID_HANDLE)
+    {
+        MLOG(MGetLibLogger(), MERR, "session slot map is full, loop:", p_session->loop_index);
+        delete p_connector;
+        delete p_session;
+        return;
+    }
+    p_session->codec.SetMessageCallback(std::bind(&NetManager::OnMessageCallback, this, p_session, std::placeholders::_1, std::placeholders::_2));
     p_connector->SetReadCallback(std::bind(&NetManager::OnReadCallback, this, p_session));
     p_connector->SetErrorCallback(std::bind(&NetManager::OnCloseCallback, this, p_session, std::placeholders::_1));
+    p_connector->SetCork(true);
     p_connector->EnableReadWrite(true);
+    p_connector->EnableIdleTimeout(NET_SESSION_READ_IDLE_TIME, NET_SESSION_WRITE_IDLE_TIME);
+    p_connector->SetWriteWatermark(NET_SESSION_HIGH_WATER_MARK, NET_SESSION_LOW_WATER_MARK
+        , std::bind(OnSessionWaterCallback, p_session, true)
+        , std::bind(OnSessionWaterCallback, p_session, false)
+        , NET_SESSION_HIGH_WATER_TIME);
     std::cout << p_session->p_connector->GetSocket()->GetRemoteIP() << " "
         << p_session->p_connector->GetSocket()->GetRemotePort() << " "
         << " has socket connect" << std::endl;
 
 }
 
-void NetManager::OnListenerErrorCallback(size_t pos, MError err)
+void NetManager::OnListenerErrorCallback(MNetListener *p_listener, MError err)
 {
-    if (listener_list_.size() >= pos)
-    {
-        return;
-    }
-    MNetListener *p_listener = listener_list_[pos];
     if (!p_listener)
     {
         return;
     }
     std::cout << "listener ip:" << p_listener->GetSocket()->GetBindIP()
-        << " port:" << p_listener->GetSocket()->GetBindPort() << std::endl;
-}
-
-MNetEventLoopThread* NetManager::GetMinEventsThread()
-{
-    if (work_list_.empty())
-    {
-        return nullptr;
-    }
-    MNetEventLoopThread *p_loop_thread = work_list_[0];
-    size_t count = work_list_[0]->GetEventCount();
-    for (size_t i = 1; i < work_list_.size(); ++i)
-    {
-        if (count > work_list_[i]->GetEventCount())
-        {
-            count = work_list_[i]->GetEventCount();
-            p_loop_thread = work_list_[i];
-        }
-    }
-    return p_loop_thread;
+        << " port:" << p_listener->GetSocket()->GetBindPort()
+        << " error:" << static_cast<int>(err) << std::endl;
 }
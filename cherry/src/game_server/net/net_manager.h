@@ -3,21 +3,42 @@
 
 #include <net/m_socket.h>
 #include <net/m_net_event_loop_thread.h>
+#include <net/m_net_event_loop_group.h>
 #include <net/m_net_connector.h>
 #include <net/m_net_listener.h>
+#include <net/m_net_loop_watchdog.h>
+#include <net/m_net_frame_codec.h>
+#include <util/m_shared_buffer.h>
+#include <util/m_slot_map.h>
+#include <util/m_object_pool.h>
 #include <thread/m_thread.h>
-#include <mutex>
+#include <atomic>
 #include <functional>
 #include <list>
 #include <util/m_singleton.h>
-#include <set>
+#include <vector>
+
+#define NET_SESSION_READ_IDLE_TIME  60000
+#define NET_SESSION_WRITE_IDLE_TIME 30000
+#define NET_LOOP_STALL_TIME         500
+#define NET_SESSION_READ_BUF_LEN    (128 * 1024)
+#define NET_SESSION_WRITE_BUF_LEN   (1024 * 1024)
+#define NET_SESSION_HIGH_WATER_MARK (512 * 1024)
+#define NET_SESSION_LOW_WATER_MARK  (128 * 1024)
+#define NET_SESSION_HIGH_WATER_TIME 10000
 
 struct NetSession
 {
+    //allocated from MObjectPool<NetSession>
+    static void* operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
+    uint64_t id;//slot map handle, the owner is the loop index
     MNetConnector *p_connector;
     MNetEventLoopThread *p_loop_thread;
-    bool len_readed;
-    uint16_t len;
+    size_t loop_index;
+    MNetFrameCodec codec;
+    std::atomic<bool> write_paused;
 };
 
 class NetManager
@@ -32,21 +53,27 @@ public:
     void Close();
 
     bool AddListener(const std::string &ip, unsigned short port);
-    void CloseSession(NetSession *p_session);
-    void WriteSession(NetSession *p_session, char *p_buf, size_t len);
+    //any thread, the id routes to the owning loop and stale ids are dropped there
+    void CloseSession(uint64_t id);
+    void WriteSession(uint64_t id, char *p_buf, size_t len);
     void WriteAll(const char *p_buf, size_t len);
+    //frame is sent as is to every session, one callback per loop thread
+    void Broadcast(const MSharedBuffer &frame);
 public:
-    void OnConnectCallback(MNetListener *p_listener, MSocket *p_sock);
-    void OnListenerErrorCallback(size_t pos, MError err);
+    void OnConnectCallback(MNetEventLoopThread *p_loop_thread, MSocket *p_sock);
+    void OnListenerErrorCallback(MNetListener *p_listener, MError err);
     void OnReadCallback(NetSession *p_session);
+    void OnMessageCallback(NetSession *p_session, const char *p_buf, size_t len);
     void OnCloseCallback(NetSession *p_session, MError err);
+    void OnCloseSessionCallback(uint64_t id);
+    void OnWriteSessionCallback(uint64_t id, char *p_buf, size_t len);
+    void OnBroadcastCallback(size_t loop_index, const MSharedBuffer &frame);
 private:
-    MNetEventLoopThread* GetMinEventsThread();
-private:
-    std::vector<MNetEventLoopThread*> work_list_;
-    std::vector<MNetListener*> listener_list_;
-    std::mutex session_mutex_;
-    std::set<NetSession*> session_list_;
+    MNetEventLoopGroup loop_group_;
+    MNetLoopWatchdog watchdog_;
+    //indexed by loop, each map is only touched by its loop thread
+    std::vector<MSlotMap<NetSession*> > loop_session_list_;
+    MNetFrameCodec frame_codec_;
 };
 
 #endif
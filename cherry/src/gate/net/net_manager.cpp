@@ -1,16 +1,22 @@
-#include <net_manager.h>
+#include <net/net_manager.h>
 
 NetManager::NetManager()
+    :p_placement_(new MNetLeastConnectionPlacement())
 {
 }
 
 NetManager::~NetManager()
 {
     Close();
+    delete p_placement_;
 }
 
 bool NetManager::Init(size_t thread_count, size_t session_count)
 {
+    if (thread_count == 0 || thread_count > MSLOT_MAP_MAX_OWNER + 1)
+    {
+        return false;
+    }
     for (size_t i = 0; i < thread_count; ++i)
     {
         MNetEventLoopThread *p_loop_thread = new MNetEventLoopThread();
@@ -28,7 +34,11 @@ bool NetManager::Init(size_t thread_count, size_t session_count)
         }
         loop_threads_.push_back(p_loop_thread);
     }
-    sessions_.resize(session_count);
+    std::vector<MSlotMap<NetSession*> >(thread_count).swap(sessions_);
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        sessions_[i].Init(static_cast<uint8_t>(i), session_count / thread_count);
+    }
     return true;
 }
 
@@ -41,6 +51,19 @@ void NetManager::Close()
             it->StopAndJoin();
         }
     }
+    for (auto &session_list : sessions_)
+    {
+        for (auto p_session : session_list)
+        {
+            delete p_session;
+        }
+    }
+    sessions_.clear();
+    for (const auto &it : listeners_)
+    {
+        delete it;
+    }
+    listeners_.clear();
     for (const auto &it : loop_threads_)
     {
         if (it)
@@ -49,34 +72,36 @@ void NetManager::Close()
             delete it;
         }
     }
+    loop_threads_.clear();
 }
 
-MNetEventLoopThread* NetManager::GetMinEventLoopThread()
+void NetManager::SetPlacement(MNetLoopPlacement *p_placement)
 {
-    if (loop_threads_.empty())
+    if (!p_placement || p_placement == p_placement_)
     {
-        return nullptr;
+        return;
     }
-    MNetEventLoopThread *p_loop_thread = nullptr;
-    size_t event_count = static_cast<size_t>(-1);
-    for (auto &it : loop_threads_)
+    delete p_placement_;
+    p_placement_ = p_placement;
+}
+
+size_t NetManager::SelectLoopIndex(uint64_t key)
+{
+    if (loop_threads_.empty())
     {
-        if (it && it->GetEventCount() < event_count)
-        {
-            p_loop_thread = it;
-            event_count = it->GetEventCount();
-        }
+        return loop_threads_.size();
     }
-    return p_loop_thread;
+    return p_placement_->Select(loop_threads_, key);
 }
 
 bool NetManager::AddListener(const std::string &ip, unsigned port)
 {
-    MNetEventLoopThread *p_loop_thread = GetMinEventLoopThread();
-    if (!p_loop_thread)
+    size_t loop_index = SelectLoopIndex(0);
+    if (loop_index >= loop_threads_.size())
     {
         return false;
     }
+    MNetEventLoopThread *p_loop_thread = loop_threads_[loop_index];
     MSocket *p_sock = new MSocket();
     if (!p_sock)
     {
@@ -93,8 +118,8 @@ bool NetManager::AddListener(const std::string &ip, unsigned port)
         delete p_sock;
         return false;
     }
-    p_listener->SetAcceptCallback(&NetManager::OnListenerAcceptCallback, this, p_listener, std::placeholders::_1);
-    p_listener->SetErrorCallback(&NetManager::OnListenerErrorCallback, this, p_listener, std::placeholders::_1);
+    p_listener->SetAcceptCallback(std::bind(&NetManager::OnListenerAcceptCallback, this, p_listener, std::placeholders::_1));
+    p_listener->SetErrorCallback(std::bind(&NetManager::OnListenerErrorCallback, this, p_listener, std::placeholders::_1));
     listeners_.push_back(p_listener);
     p_loop_thread->AddCallback(std::bind(&NetManager::OnListenerEnableCallback, this, p_listener));
     if (p_loop_thread->Interrupt() != MError::No)
@@ -105,8 +130,27 @@ bool NetManager::AddListener(const std::string &ip, unsigned port)
     return true;
 }
 
-bool NetManager::SendSessionMsg(int64_t id, char *p_buf, size_t len)
+bool NetManager::SendSessionMsg(uint64_t id, char *p_buf, size_t len)
 {
+    size_t loop_index = MSlotMap<NetSession*>::GetOwner(id);
+    if (loop_index >= loop_threads_.size())
+    {
+        delete[] p_buf;
+        return false;
+    }
+    loop_threads_[loop_index]->AddCallback(std::bind(&NetManager::OnSessionSendCallback, this, id, p_buf, len));
+    return loop_threads_[loop_index]->Interrupt() == MError::No;
+}
+
+bool NetManager::CloseSession(uint64_t id)
+{
+    size_t loop_index = MSlotMap<NetSession*>::GetOwner(id);
+    if (loop_index >= loop_threads_.size())
+    {
+        return false;
+    }
+    loop_threads_[loop_index]->AddCallback(std::bind(&NetManager::OnSessionCloseCallback, this, id));
+    return loop_threads_[loop_index]->Interrupt() == MError::No;
 }
 
 void NetManager::OnListenerAcceptCallback(MNetListener *p_listener, MSocket *p_sock)
@@ -115,21 +159,22 @@ void NetManager::OnListenerAcceptCallback(MNetListener *p_listener, MSocket *p_s
     {
         return;
     }
-    MNetEventLoopThread *p_loop_thread = GetMinEventLoopThread();
-    if (!p_loop_thread)
+    size_t loop_index = SelectLoopIndex(MNetLoopPlacement::HashKey(p_sock->GetRemoteIP()));
+    if (loop_index >= loop_threads_.size())
     {
         delete p_sock;
         return;
     }
-    NetSession *p_session = new NetSession(p_sock, p_loop_thread, nullptr, nullptr, 4096, 2048);
-    if (!p_sock)
+    MNetEventLoopThread *p_loop_thread = loop_threads_[loop_index];
+    NetSession *p_session = new NetSession(p_sock, p_loop_thread, nullptr, nullptr, NET_SESSION_READ_LEN, NET_SESSION_WRITE_LEN);
+    if (!p_session)
     {
         delete p_sock;
         return;
     }
-    p_session->SetReadCallback(std::bind(&NetManager::OnSessionReadCallback, this, p_session, std::placeholders::_1, std::placeholders::_2));
+    p_session->SetMessageCallback(std::bind(&NetManager::OnSessionMessageCallback, this, p_session, std::placeholders::_1, std::placeholders::_2));
     p_session->SetErrorCallback(std::bind(&NetManager::OnSessionInitErrorCallback, this, p_session, std::placeholders::_1));
-    p_loop_thread->AddCallback(std::bind(&NetManager::OnSessionEnableCallback, this, p_session));
+    p_loop_thread->AddCallback(std::bind(&NetManager::OnSessionEnableCallback, this, loop_index, p_session));
     if (p_loop_thread->Interrupt() != MError::No)
     {
         //print error
@@ -154,7 +199,7 @@ void NetManager::OnListenerEnableCallback(MNetListener *p_listener)
     }
 }
 
-void NetManager::OnSessionReadCallback(NetSession *p_session, char *p_buf, size_t len)
+void NetManager::OnSessionMessageCallback(NetSession *p_session, const char *p_buf, size_t len)
 {
     if (!p_session || !p_buf)
     {
@@ -179,20 +224,13 @@ void NetManager::OnSessionErrorCallback(NetSession *p_session, MError err)
     {
         return;
     }
-    {
-        std::lock_guard<std::mutex> lock(session_mtx_);
-        auto it = sessions_.find(p_session->GetID());
-        if (it != sessions_.end())
-        {
-            sessions_.erase(it);
-        }
-    }
-    int64_t id = p_session->GetID();
+    uint64_t id = p_session->GetID();
+    sessions_[MSlotMap<NetSession*>::GetOwner(id)].Remove(id);
     delete p_session;
     /////TODO
 }
 
-void NetManager::OnSessionEnableCallback(NetSession *p_session)
+void NetManager::OnSessionEnableCallback(size_t loop_index, NetSession *p_session)
 {
     if (!p_session)
     {
@@ -210,19 +248,34 @@ void NetManager::OnSessionEnableCallback(NetSession *p_session)
         delete p_session;
         return;
     }
+    uint64_t id = sessions_[loop_index].Insert(p_session);
+    if (id == MSLOT_MAP_INVALID_HANDLE)
     {
-        std::lock_guard<std::mutex> lock(session_mtx_);
-        if (++session_index_ >= 2^15)
-        {
-            session_index_ = 1;
-        }
-        int64_t session_id = session_index_ << 16 + p_sock->GetHandler();
-        if (sessions_.find(session_id) != sessions_.end())
-        {
-            delete p_session;
-            return;
-        }
-        p_session->SetID(session_id);
-        sessions_[session_id] = p_session;
+        delete p_session;
+        return;
     }
+    p_session->SetID(id);
+}
+
+void NetManager::OnSessionSendCallback(uint64_t id, char *p_buf, size_t len)
+{
+    NetSession **pp_session = sessions_[MSlotMap<NetSession*>::GetOwner(id)].Get(id);
+    if (pp_session)
+    {
+        (*pp_session)->SendPackage(p_buf, len);
+    }
+    delete[] p_buf;
+}
+
+void NetManager::OnSessionCloseCallback(uint64_t id)
+{
+    MSlotMap<NetSession*> &session_list = sessions_[MSlotMap<NetSession*>::GetOwner(id)];
+    NetSession **pp_session = session_list.Get(id);
+    if (!pp_session)
+    {
+        return;
+    }
+    NetSession *p_session = *pp_session;
+    session_list.Remove(id);
+    delete p_session;
 }
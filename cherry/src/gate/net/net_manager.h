@@ -2,12 +2,17 @@
 #define _NET_MANAGER_H_
 
 #include <util/m_singleton.h>
-#include <map>
-#include <net_session.h>
+#include <util/m_slot_map.h>
+#include <net/net_session.h>
 #include <net/m_net_event_loop_thread.h>
 #include <net/m_net_listener.h>
+#include <net/m_net_loop_placement.h>
+#include <net/m_socket.h>
 #include <string>
-#include <mutex>
+#include <vector>
+
+#define NET_SESSION_READ_LEN  4096
+#define NET_SESSION_WRITE_LEN 2048
 
 class NetManager
     :public MSingleton<NetManager>
@@ -20,24 +25,31 @@ public:
 public:
     bool Init(size_t thread_count, size_t session_count);
     void Close();
-    MNetEventLoopThread* GetMinEventLoopThread();
+    //the manager owns the policy, least connections by default
+    void SetPlacement(MNetLoopPlacement *p_placement);
+    //loop_threads_.size() if there is no loop
+    size_t SelectLoopIndex(uint64_t key);
     bool AddListener(const std::string &ip, unsigned port);
-    bool SendSessionMsg(int64_t id, char *p_buf, size_t len);
-    bool CloseSession(int64_t id);
+    //any thread, the id routes to the owning loop and stale ids are dropped there
+    //p_buf must come from new[], the manager frees it
+    bool SendSessionMsg(uint64_t id, char *p_buf, size_t len);
+    bool CloseSession(uint64_t id);
 public://async
     void OnListenerAcceptCallback(MNetListener *p_listener, MSocket *p_sock);
     void OnListenerErrorCallback(MNetListener *p_listener, MError err);
     void OnListenerEnableCallback(MNetListener *p_listener);
-    void OnSessionReadCallback(NetSession *p_session, char *p_buf, size_t len);
+    void OnSessionMessageCallback(NetSession *p_session, const char *p_buf, size_t len);
     void OnSessionInitErrorCallback(NetSession *p_session, MError err);
     void OnSessionErrorCallback(NetSession *p_session, MError err);
-    void OnSessionEnableCallback(NetSession *p_session);
+    void OnSessionEnableCallback(size_t loop_index, NetSession *p_session);
+    void OnSessionSendCallback(uint64_t id, char *p_buf, size_t len);
+    void OnSessionCloseCallback(uint64_t id);
 private:
     std::vector<MNetListener*> listeners_;
     std::vector<MNetEventLoopThread*> loop_threads_;
-    std::map<int64_t, NetSession*> sessions_;
-    std::mutex session_mtx_;
-    int64_t session_index_;
+    //indexed by loop, each map is only touched by its loop thread
+    std::vector<MSlotMap<NetSession*> > sessions_;
+    MNetLoopPlacement *p_placement_;
 };
 
 #endif
@@ -1,66 +1,74 @@
-#include <net_session.h>
+#include <net/net_session.h>
+#include <util/m_object_pool.h>
 
-NetSession::NetSession(MSocket *p_sock, MNetEventLoopThread *p_event_loop_thread, const std::function<void (MError)> &error_cb)
-    :connector_(p_sock, p_event_loop_thread ? &p_event_loop_thread->GetEventLoop() : nullptr, nullptr, nullptr, nullptr, error_cb, true, NET_READ_LEN, NET_WRITE_LEN)
+NetSession::NetSession(MSocket *p_sock, MNetEventLoopThread *p_event_loop_thread, const std::function<void (const char*, size_t)> &message_cb, const std::function<void (MError)> &error_cb, size_t read_len, size_t write_len)
+    :connector_(p_sock, p_event_loop_thread ? &p_event_loop_thread->GetEventLoop() : nullptr, nullptr, nullptr, nullptr, error_cb, true, read_len, write_len)
     ,p_event_loop_thread_(p_event_loop_thread)
-    ,recv_pkg_len_(0)
-    ,recv_pkg_len_read_(false)
+    ,codec_(MNetFrameHeader::Fixed16, 65535, message_cb)
+    ,id_(0)
 {
     connector_.SetReadCallback(std::bind(&NetSession::OnReadCallback, this));
-    connector_.SetErrorCallback(error_cb);
-    connector_.EnableReadWrite(true);
 }
 
 NetSession::~NetSession()
 {
 }
 
-bool NetSession::SendNetPkg(const NetPackage &pkg)
+void* NetSession::operator new(size_t size)
 {
-    if (!p_connector_ || !p_event_loop_thread_)
-    {
-        return false;
-    }
-    std::lock_guard<std::mutex> lock(send_pkg_mtx_);
-    send_pkg_list_.push_back(pkg);
-    p_event_loop_thread_->AddCallback(std::bind(&NetSession::OnWriteCallback, this));
-    if (send_pkg_list_.size() == 1)
-    {
-        p_event_loop_thread_->Interrupt();
-    }
-    return true;
+    return MObjectPool<NetSession>::Alloc(size);
 }
 
-void NetSession::Update()
+void NetSession::operator delete(void *p, size_t size)
 {
-    std::list<NetPackage> pkg_list;
-    {
-        std::lock_guard<std::mutex> lock(recv_pkg_mtx_);
-        pkg_list.swap(recv_pkg_list_);
-    }
-    //handler pkg;
+    MObjectPool<NetSession>::Free(p, size);
 }
 
-void NetSession::OnReadCallback()
+void NetSession::SetID(uint64_t id)
 {
-    if (!recv_pkg_len_read_)
-    {
-        if (!connector_.ReadBuf(&recv_pkg_len_, sizeof(recv_pkg_len_)))
-        {
-            return;
-        }
-        recv_pkg_len_read_ = true;
-    }
-    if (recv_pkg_len_read_)
-    {
-        if (connector_.GetReadBufLen() < recv_pkg_len_)
-        {
-            return;
-        }
-    }
+    id_ = id;
+}
+
+uint64_t NetSession::GetID() const
+{
+    return id_;
 }
 
-void NetSession::OnWriteCallback()
+MSocket* NetSession::GetSocket()
 {
-    connector_.SendNetPkg();
+    return connector_.GetSocket();
+}
+
+MNetEventLoopThread* NetSession::GetEventLoopThread()
+{
+    return p_event_loop_thread_;
+}
+
+void NetSession::SetMessageCallback(const std::function<void (const char*, size_t)> &message_cb)
+{
+    codec_.SetMessageCallback(message_cb);
+}
+
+void NetSession::SetErrorCallback(const std::function<void (MError)> &error_cb)
+{
+    connector_.SetErrorCallback(error_cb);
+}
+
+MError NetSession::EnableReadWrite(bool enable)
+{
+    return connector_.EnableReadWrite(enable);
+}
+
+MError NetSession::SendPackage(const char *p_buf, size_t len)
+{
+    return codec_.Write(&connector_, p_buf, len);
+}
+
+void NetSession::OnReadCallback()
+{
+    MError err = codec_.Decode(&connector_);
+    if (err != MError::No)
+    {
+        connector_.OnErrorCallback(err);
+    }
 }
@@ -3,6 +3,8 @@
 #include <db/m_db_command.h>
 #include <util/m_logger.h>
 
+#define LOGIN_SERVER_FRAME_RATE 20
+
 LoginServer::LoginServer()
     :p_db_conn_(nullptr)
 {
@@ -58,16 +60,33 @@ bool LoginServer::Init(const std::string &db_conn_string)
     {
         std::cout << it.id << "," << it.name << "," << it.ip << "," << it.port << std::endl;
     }
+    if (event_loop_.Init() != MError::No)
+    {
+        MLOG(MGetLibLogger(), MERR, "init event loop failed");
+        return false;
+    }
+    if (frame_scheduler_.Init(&event_loop_) != MError::No
+        || frame_scheduler_.Start(std::bind(&LoginServer::OnFrame, this), LOGIN_SERVER_FRAME_RATE) != MError::No)
+    {
+        MLOG(MGetLibLogger(), MERR, "start frame scheduler failed");
+        return false;
+    }
     return true;
 }
 
 void LoginServer::Clear()
 {
+    frame_scheduler_.Stop();
+    event_loop_.Clear();
 }
 
 bool LoginServer::Update()
 {
-    return true;
+    return event_loop_.DispatchEventOnce() == MError::No;
+}
+
+void LoginServer::OnFrame()
+{
 }
 
 bool LoginServer::LoadConf()
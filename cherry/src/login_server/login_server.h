@@ -7,6 +7,8 @@
 #include <list>
 #include <string>
 #include <util/m_type_define.h>
+#include <event/m_event_loop.h>
+#include <event/m_frame_scheduler.h>
 
 struct GameServInfo
 {
@@ -28,7 +30,10 @@ public:
     bool Update();
 private:
     bool LoadConf();
+    void OnFrame();
 private:
+    MEventLoop event_loop_;
+    MFrameScheduler frame_scheduler_;
     MDbConnection *p_db_conn_;
     std::string db_conn_string_;
     std::list<GameServInfo> game_serv_info_list_;
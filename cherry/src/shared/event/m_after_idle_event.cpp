@@ -16,15 +16,15 @@ MError MAfterIdleEvent::Init(MEventLoop *p_event_loop)
     {
         return MError::Invalid;
     }
-    return this->MTimerEventBase::Init(p_event_loop);
+    return this->MAfterEventBase::Init(p_event_loop);
 }
 
 void MAfterIdleEvent::Clear()
 {
-    this->MTimerEventBase::Clear();
+    this->MAfterEventBase::Clear();
 }
 
-MError MAfterIdleEvent::EnableEvent(const std::function<void ()> &cb, int repeated)
+MError MAfterIdleEvent::EnableEvent(MInlineFunction<void ()> cb, int repeated)
 {
     if (!cb)
     {
@@ -35,14 +35,14 @@ MError MAfterIdleEvent::EnableEvent(const std::function<void ()> &cb, int repeat
     {
         return err;
     }
-    cb_ = cb;
+    cb_ = std::move(cb);
     repeated_ = repeated;
-    return this->MTimerEventBase::EnableEvent();
+    return this->MAfterEventBase::EnableEvent();
 }
 
 MError MAfterIdleEvent::DisableEvent()
 {
-    return this->MTimerEventBase::DisableEvent();
+    return this->MAfterEventBase::DisableEvent();
 }
 
 void MAfterIdleEvent::_OnCallback()
@@ -54,6 +54,6 @@ void MAfterIdleEvent::_OnCallback()
         {
             --repeated_;
         }
-        this->MTimerEventBase::EnableEvent();
+        this->MAfterEventBase::EnableEvent();
     }
 }
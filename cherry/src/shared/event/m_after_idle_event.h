@@ -2,10 +2,11 @@
 #define _M_AFTER_IDLE_EVENT_H_
 
 #include <util/m_errno.h>
-#include <event/m_event_base.h>
-#include <functional>
+#include <event/m_event_loop.h>
+#include <util/m_inline_function.h>
 
 class MAfterIdleEvent
+    :public MAfterEventBase
 {
 public:
     MAfterIdleEvent();
@@ -15,12 +16,12 @@ public:
 public:
     MError Init(MEventLoop *p_event_loop);
     void Clear();
-    MError EnableEvent(const std::function<void ()> &cb, int repeated = 0);
+    MError EnableEvent(MInlineFunction<void ()> cb, int repeated = 0);
     MError DisableEvent();
 private:
     virtual void _OnCallback() override;
 private:
-    std::function<void ()> cb_;
+    MInlineFunction<void ()> cb_;
     int repeated_;
 };
 
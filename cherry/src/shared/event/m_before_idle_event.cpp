@@ -16,15 +16,15 @@ MError MBeforeIdleEvent::Init(MEventLoop *p_event_loop)
     {
         return MError::Invalid;
     }
-    return this->MTimerEventBase::Init(p_event_loop);
+    return this->MBeforeEventBase::Init(p_event_loop);
 }
 
 void MBeforeIdleEvent::Clear()
 {
-    this->MTimerEventBase::Clear();
+    this->MBeforeEventBase::Clear();
 }
 
-MError MBeforeIdleEvent::EnableEvent(const std::function<void ()> &cb, int repeated)
+MError MBeforeIdleEvent::EnableEvent(MInlineFunction<void ()> cb, int repeated)
 {
     if (!cb)
     {
@@ -35,14 +35,14 @@ MError MBeforeIdleEvent::EnableEvent(const std::function<void ()> &cb, int repea
     {
         return err;
     }
-    cb_ = cb;
+    cb_ = std::move(cb);
     repeated_ = repeated;
-    return this->MTimerEventBase::EnableEvent();
+    return this->MBeforeEventBase::EnableEvent();
 }
 
 MError MBeforeIdleEvent::DisableEvent()
 {
-    return this->MTimerEventBase::DisableEvent();
+    return this->MBeforeEventBase::DisableEvent();
 }
 
 void MBeforeIdleEvent::_OnCallback()
@@ -54,6 +54,6 @@ void MBeforeIdleEvent::_OnCallback()
         {
             --repeated_;
         }
-        this->MTimerEventBase::EnableEvent();
+        this->MBeforeEventBase::EnableEvent();
     }
 }
@@ -0,0 +1,432 @@
+#ifndef _M_COROUTINE_H_
+#define _M_COROUTINE_H_
+
+#if defined(__cpp_impl_coroutine) && __cplusplus >= 202002L
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <cstddef>
+#include <new>
+#include <util/m_logger.h>
+#include <event/m_event_base.h>
+#include <event/m_event_loop.h>
+
+#define MCOROUTINE_FRAME_ALIGN      64
+#define MCOROUTINE_FRAME_CLASSES    16
+#define MCOROUTINE_FRAME_FREE_LIMIT 256
+
+class MCoroutineFramePool
+{
+    struct MFreeNode
+    {
+        MFreeNode *p_next;
+    };
+    struct MFreeList
+    {
+        MFreeNode *p_head = nullptr;
+        size_t count = 0;
+    };
+public:
+    static void* Alloc(size_t size)
+    {
+        size_t index = GetClass(size);
+        if (index >= MCOROUTINE_FRAME_CLASSES)
+        {
+            return ::operator new(size);
+        }
+        MFreeList &list = GetFreeList(index);
+        if (list.p_head)
+        {
+            MFreeNode *p_node = list.p_head;
+            list.p_head = p_node->p_next;
+            --list.count;
+            return p_node;
+        }
+        return ::operator new((index + 1) * MCOROUTINE_FRAME_ALIGN);
+    }
+    static void Free(void *p, size_t size)
+    {
+        size_t index = GetClass(size);
+        if (index >= MCOROUTINE_FRAME_CLASSES)
+        {
+            ::operator delete(p);
+            return;
+        }
+        MFreeList &list = GetFreeList(index);
+        if (list.count >= MCOROUTINE_FRAME_FREE_LIMIT)
+        {
+            ::operator delete(p);
+            return;
+        }
+        MFreeNode *p_node = static_cast<MFreeNode*>(p);
+        p_node->p_next = list.p_head;
+        list.p_head = p_node;
+        ++list.count;
+    }
+private:
+    static size_t GetClass(size_t size)
+    {
+        return (size + MCOROUTINE_FRAME_ALIGN - 1) / MCOROUTINE_FRAME_ALIGN - 1;
+    }
+    static MFreeList& GetFreeList(size_t index)
+    {
+        struct MFreeLists
+        {
+            ~MFreeLists()
+            {
+                for (auto &list : lists)
+                {
+                    while (list.p_head)
+                    {
+                        MFreeNode *p_node = list.p_head;
+                        list.p_head = p_node->p_next;
+                        ::operator delete(p_node);
+                    }
+                }
+            }
+            MFreeList lists[MCOROUTINE_FRAME_CLASSES];
+        };
+        static thread_local MFreeLists free_lists;
+        return free_lists.lists[index];
+    }
+};
+
+template<typename T>
+class MTask;
+
+class MTaskPromiseBase
+{
+    struct MFinalAwaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            MTaskPromiseBase &promise = handle.promise();
+            if (promise.detached_)
+            {
+                handle.destroy();
+                return std::noop_coroutine();
+            }
+            if (promise.continuation_)
+            {
+                return promise.continuation_;
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept
+        {
+        }
+    };
+public:
+    static void* operator new(size_t size)
+    {
+        return MCoroutineFramePool::Alloc(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        MCoroutineFramePool::Free(p, size);
+    }
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+    MFinalAwaiter final_suspend() const noexcept
+    {
+        return {};
+    }
+    void unhandled_exception()
+    {
+        if (detached_)
+        {
+            MLOG(MGetLibLogger(), MERR, "detached task throw exception");
+            return;
+        }
+        exception_ = std::current_exception();
+    }
+    void SetContinuation(std::coroutine_handle<> continuation)
+    {
+        continuation_ = continuation;
+    }
+    void SetDetached()
+    {
+        detached_ = true;
+    }
+protected:
+    void RethrowIfException()
+    {
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+    }
+private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+    bool detached_ = false;
+};
+
+template<typename T>
+class MTaskPromise
+    :public MTaskPromiseBase
+{
+public:
+    MTask<T> get_return_object();
+    template<typename U>
+    void return_value(U &&value)
+    {
+        value_ = std::forward<U>(value);
+    }
+    T GetResult()
+    {
+        RethrowIfException();
+        return std::move(value_);
+    }
+private:
+    T value_{};
+};
+
+template<>
+class MTaskPromise<void>
+    :public MTaskPromiseBase
+{
+public:
+    MTask<void> get_return_object();
+    void return_void()
+    {
+    }
+    void GetResult()
+    {
+        RethrowIfException();
+    }
+};
+
+template<typename T = void>
+class MTask
+{
+public:
+    using promise_type = MTaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+public:
+    MTask()
+        :handle_(nullptr)
+    {
+    }
+    explicit MTask(handle_type handle)
+        :handle_(handle)
+    {
+    }
+    ~MTask()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+    MTask(MTask &&other) noexcept
+        :handle_(std::exchange(other.handle_, nullptr))
+    {
+    }
+    MTask& operator=(MTask &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    MTask(const MTask &) = delete;
+    MTask& operator=(const MTask &) = delete;
+public:
+    bool IsValid() const
+    {
+        return static_cast<bool>(handle_);
+    }
+    bool IsDone() const
+    {
+        return !handle_ || handle_.done();
+    }
+    //start the task and let it free itself when finished
+    void Detach()
+    {
+        if (!handle_)
+        {
+            return;
+        }
+        handle_type handle = std::exchange(handle_, nullptr);
+        handle.promise().SetDetached();
+        handle.resume();
+    }
+    bool await_ready() const noexcept
+    {
+        return !handle_ || handle_.done();
+    }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+    {
+        handle_.promise().SetContinuation(continuation);
+        return handle_;
+    }
+    T await_resume()
+    {
+        return handle_.promise().GetResult();
+    }
+private:
+    handle_type handle_;
+};
+
+template<typename T>
+inline MTask<T> MTaskPromise<T>::get_return_object()
+{
+    return MTask<T>(std::coroutine_handle<MTaskPromise<T> >::from_promise(*this));
+}
+
+inline MTask<void> MTaskPromise<void>::get_return_object()
+{
+    return MTask<void>(std::coroutine_handle<MTaskPromise<void> >::from_promise(*this));
+}
+
+class MIOAwaiter
+    :public MIOEventBase
+{
+public:
+    MIOAwaiter(MEventLoop *p_event_loop, int fd, unsigned events)
+        :p_loop_(p_event_loop)
+        ,wait_fd_(fd)
+        ,wait_events_(events)
+        ,revents_(0)
+    {
+    }
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        if (Init(p_loop_, wait_fd_) != MError::No
+            || EnableEvent(wait_events_) != MError::No)
+        {
+            revents_ = MIOEVENT_ERR;
+            return false;
+        }
+        return true;
+    }
+    unsigned await_resume() const noexcept
+    {
+        return revents_;
+    }
+private:
+    virtual void _OnCallback(unsigned events) override
+    {
+        revents_ = events;
+        DisableAllEvent();
+        handle_.resume();
+    }
+private:
+    MEventLoop *p_loop_;
+    int wait_fd_;
+    unsigned wait_events_;
+    unsigned revents_;
+    std::coroutine_handle<> handle_;
+};
+
+class MSleepAwaiter
+    :public MTimerEventBase
+{
+public:
+    MSleepAwaiter(MEventLoop *p_event_loop, int64_t timeout)
+        :p_loop_(p_event_loop)
+        ,timeout_(timeout)
+        ,err_(MError::No)
+    {
+    }
+public:
+    bool await_ready() const noexcept
+    {
+        return timeout_ <= 0;
+    }
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        if ((err_ = Init(p_loop_)) != MError::No
+            || (err_ = EnableEvent(p_loop_->GetTime() + timeout_)) != MError::No)
+        {
+            return false;
+        }
+        return true;
+    }
+    MError await_resume() const noexcept
+    {
+        return err_;
+    }
+private:
+    virtual void _OnCallback() override
+    {
+        handle_.resume();
+    }
+private:
+    MEventLoop *p_loop_;
+    int64_t timeout_;
+    MError err_;
+    std::coroutine_handle<> handle_;
+};
+
+class MPostAwaiter
+{
+public:
+    explicit MPostAwaiter(MEventLoop *p_event_loop)
+        :p_event_loop_(p_event_loop)
+        ,err_(MError::No)
+    {
+    }
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        err_ = p_event_loop_->Post([handle]() { handle.resume(); });
+        return err_ == MError::No;
+    }
+    MError await_resume() const noexcept
+    {
+        return err_;
+    }
+private:
+    MEventLoop *p_event_loop_;
+    MError err_;
+};
+
+inline MIOAwaiter MReadable(MEventLoop *p_event_loop, int fd)
+{
+    return MIOAwaiter(p_event_loop, fd, MIOEVENT_IN | MIOEVENT_RDHUP);
+}
+
+inline MIOAwaiter MWritable(MEventLoop *p_event_loop, int fd)
+{
+    return MIOAwaiter(p_event_loop, fd, MIOEVENT_OUT);
+}
+
+inline MSleepAwaiter MSleepFor(MEventLoop *p_event_loop, int64_t timeout)
+{
+    return MSleepAwaiter(p_event_loop, timeout);
+}
+
+inline MPostAwaiter MPostTo(MEventLoop *p_event_loop)
+{
+    return MPostAwaiter(p_event_loop);
+}
+
+#endif
+
+#endif
@@ -1,11 +1,68 @@
 #include <event/m_event_loop.h>
 #include <event/m_event_base.h>
+#include <util/m_time.h>
+#include <typeinfo>
+
+MEventListHook::MEventListHook()
+    :p_prev_(this)
+    ,p_next_(this)
+{
+}
+
+MEventListHook::~MEventListHook()
+{
+    Unlink();
+}
+
+bool MEventListHook::IsLinked() const
+{
+    return p_next_ != this;
+}
+
+MEventListHook* MEventListHook::GetNext() const
+{
+    return p_next_;
+}
+
+void MEventListHook::PushBack(MEventListHook *p_hook)
+{
+    p_hook->p_next_ = this;
+    p_hook->p_prev_ = p_prev_;
+    p_prev_->p_next_ = p_hook;
+    p_prev_ = p_hook;
+}
+
+void MEventListHook::Unlink()
+{
+    p_prev_->p_next_ = p_next_;
+    p_next_->p_prev_ = p_prev_;
+    p_prev_ = this;
+    p_next_ = this;
+}
+
+void MEventListHook::Splice(MEventListHook &list)
+{
+    if (!list.IsLinked())
+    {
+        return;
+    }
+    list.p_prev_->p_next_ = this;
+    list.p_next_->p_prev_ = p_prev_;
+    p_prev_->p_next_ = list.p_next_;
+    p_prev_ = list.p_prev_;
+    list.p_prev_ = &list;
+    list.p_next_ = &list;
+}
 
 MIOEventBase::MIOEventBase()
     :p_event_loop_(nullptr)
     ,fd_(-1)
     ,events_(0)
     ,actived_(false)
+    ,applied_events_(0)
+    ,uring_slot_(static_cast<uint32_t>(-1))
+    ,uring_user_data_(0)
+    ,uring_changed_(false)
 {
 }
 
@@ -48,7 +105,10 @@ MError MIOEventBase::Init(MEventLoop *p_event_loop, int fd)
 
 void MIOEventBase::Clear()
 {
-    DisableAllEvent();
+    if (p_event_loop_)
+    {
+        DisableAllEvent();
+    }
 }
 
 MError MIOEventBase::EnableEvent(unsigned events)
@@ -78,12 +138,27 @@ void MIOEventBase::SetActived(bool actived)
 
 void MIOEventBase::OnCallback(unsigned events)
 {
+    MEventLoopProfiler *p_profiler = p_event_loop_->GetProfiler();
+    if (!p_profiler)
+    {
+        _OnCallback(events);
+        return;
+    }
+    const char *p_type_name = typeid(*this).name();
+    int64_t start_time = MTime::GetMonotonicNanoTime();
     _OnCallback(events);
+    p_profiler->RecordCallback(p_type_name, MTime::GetMonotonicNanoTime() - start_time);
 }
 
 MTimerEventBase::MTimerEventBase()
     :p_event_loop_(nullptr)
     ,actived_(false)
+    ,high_res_(false)
+    ,start_time_(0)
+    ,expect_time_(0)
+    ,p_next_(nullptr)
+    ,pp_prev_(nullptr)
+    ,heap_index_(static_cast<size_t>(-1))
 {
 }
 
@@ -97,6 +172,21 @@ bool MTimerEventBase::IsActived() const
     return actived_;
 }
 
+bool MTimerEventBase::IsHighRes() const
+{
+    return high_res_;
+}
+
+int64_t MTimerEventBase::GetStartTime() const
+{
+    return start_time_;
+}
+
+int64_t MTimerEventBase::GetExpectTime() const
+{
+    return expect_time_;
+}
+
 MError MTimerEventBase::Init(MEventLoop *p_event_loop)
 {
     if (!p_event_loop)
@@ -110,12 +200,20 @@ MError MTimerEventBase::Init(MEventLoop *p_event_loop)
 
 void MTimerEventBase::Clear()
 {
-    DisableEvent();
+    if (p_event_loop_)
+    {
+        DisableEvent();
+    }
 }
 
-MError MTimerEventBase::EnableEvent(int64_t start_time)
+MError MTimerEventBase::EnableEvent(int64_t start_time, int64_t slack_time)
 {
-    return p_event_loop_->AddTimerEvent(start_time, this);
+    return p_event_loop_->AddTimerEvent(start_time, this, slack_time);
+}
+
+MError MTimerEventBase::EnableNanoEvent(int64_t start_nano_time)
+{
+    return p_event_loop_->AddNanoTimerEvent(start_nano_time, this);
 }
 
 MError MTimerEventBase::DisableEvent()
@@ -123,14 +221,19 @@ MError MTimerEventBase::DisableEvent()
     return p_event_loop_->DelTimerEvent(this);
 }
 
-void MTimerEventBase::SetLocation(MTimerEventLocation location)
+void MTimerEventBase::SetHighRes(bool high_res)
 {
-    location_ = location;
+    high_res_ = high_res;
 }
 
-MTimerEventLocation MTimerEventBase::GetLocation() const
+void MTimerEventBase::SetStartTime(int64_t start_time)
 {
-    return location_;
+    start_time_ = start_time;
+}
+
+void MTimerEventBase::SetExpectTime(int64_t expect_time)
+{
+    expect_time_ = expect_time;
 }
 
 void MTimerEventBase::SetActived(bool actived)
@@ -140,7 +243,17 @@ void MTimerEventBase::SetActived(bool actived)
 
 void MTimerEventBase::OnCallback()
 {
+    MEventLoopProfiler *p_profiler = p_event_loop_->GetProfiler();
+    if (!p_profiler)
+    {
+        _OnCallback();
+        return;
+    }
+    const char *p_type_name = typeid(*this).name();
+    int64_t start_time = MTime::GetMonotonicNanoTime();
+    p_profiler->RecordTimerLateness(high_res_ ? start_time - expect_time_ : start_time - expect_time_ * 1000000);
     _OnCallback();
+    p_profiler->RecordCallback(p_type_name, MTime::GetMonotonicNanoTime() - start_time);
 }
 
 MBeforeEventBase::MBeforeEventBase()
@@ -154,7 +267,7 @@ MBeforeEventBase::~MBeforeEventBase()
     Clear();
 }
 
-void MBeforeEventBase::IsActived()
+bool MBeforeEventBase::IsActived() const
 {
     return actived_;
 }
@@ -172,7 +285,10 @@ MError MBeforeEventBase::Init(MEventLoop *p_event_loop)
 
 void MBeforeEventBase::Clear()
 {
-    DisableEvent();
+    if (p_event_loop_)
+    {
+        DisableEvent();
+    }
 }
 
 MError MBeforeEventBase::EnableEvent()
@@ -185,16 +301,6 @@ MError MBeforeEventBase::DisableEvent()
     return p_event_loop_->DelBeforeEvent(this);
 }
 
-void MBeforeEventBase::SetLocation(MBeforeEventLocation location)
-{
-    location_ = location;
-}
-
-MBeforeEventLocation MBeforeEventBase::GetLocation() const
-{
-    return location_;
-}
-
 void MBeforeEventBase::SetActived(bool actived)
 {
     actived_ = actived;
@@ -202,7 +308,16 @@ void MBeforeEventBase::SetActived(bool actived)
 
 void MBeforeEventBase::OnCallback()
 {
+    MEventLoopProfiler *p_profiler = p_event_loop_->GetProfiler();
+    if (!p_profiler)
+    {
+        _OnCallback();
+        return;
+    }
+    const char *p_type_name = typeid(*this).name();
+    int64_t start_time = MTime::GetMonotonicNanoTime();
     _OnCallback();
+    p_profiler->RecordCallback(p_type_name, MTime::GetMonotonicNanoTime() - start_time);
 }
 
 MAfterEventBase::MAfterEventBase()
@@ -223,7 +338,7 @@ bool MAfterEventBase::IsActived() const
 
 MError MAfterEventBase::Init(MEventLoop *p_event_loop)
 {
-    if (p_event_loop)
+    if (!p_event_loop)
     {
         return MError::Invalid;
     }
@@ -234,7 +349,10 @@ MError MAfterEventBase::Init(MEventLoop *p_event_loop)
 
 void MAfterEventBase::Clear()
 {
-    DisableEvent();
+    if (p_event_loop_)
+    {
+        DisableEvent();
+    }
 }
 
 MError MAfterEventBase::EnableEvent()
@@ -252,17 +370,16 @@ void MAfterEventBase::SetActived(bool actived)
     actived_ = actived;
 }
 
-void MAfterEventBase::SetLocation(MAfterEventLocation location)
-{
-    location_ = location;
-}
-
-MAfterEventLocation MAfterEventBase::GetLocation() const
-{
-    return location_;
-}
-
 void MAfterEventBase::OnCallback()
 {
+    MEventLoopProfiler *p_profiler = p_event_loop_->GetProfiler();
+    if (!p_profiler)
+    {
+        _OnCallback();
+        return;
+    }
+    const char *p_type_name = typeid(*this).name();
+    int64_t start_time = MTime::GetMonotonicNanoTime();
     _OnCallback();
+    p_profiler->RecordCallback(p_type_name, MTime::GetMonotonicNanoTime() - start_time);
 }
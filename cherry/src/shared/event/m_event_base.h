@@ -19,7 +19,26 @@
 
 class MEventLoop;
 
+class MEventListHook
+{
+public:
+    MEventListHook();
+    ~MEventListHook();
+    MEventListHook(const MEventListHook &) = delete;
+    MEventListHook& operator=(const MEventListHook &) = delete;
+public:
+    bool IsLinked() const;
+    MEventListHook* GetNext() const;
+    void PushBack(MEventListHook *p_hook);
+    void Unlink();
+    void Splice(MEventListHook &list);
+private:
+    MEventListHook *p_prev_;
+    MEventListHook *p_next_;
+};
+
 class MIOEventBase
+    :private MEventListHook
 {
 public:
     MIOEventBase();
@@ -47,11 +66,14 @@ private:
     int fd_;
     unsigned events_;
     bool actived_;
+    unsigned applied_events_;
+    uint32_t uring_slot_;
+    uint64_t uring_user_data_;
+    bool uring_changed_;
 };
 
 class MTimerEventBase
 {
-    typedef std::multimap<int64_t, MTimerEventBase*>::iterator MTimerEventLocation;
 public:
     MTimerEventBase();
     virtual ~MTimerEventBase();
@@ -59,27 +81,39 @@ public:
     MTimerEventBase& operator=(const MTimerEventBase &) = delete;
 public:
     bool IsActived() const;
+    bool IsHighRes() const;
+    int64_t GetStartTime() const;
+    int64_t GetExpectTime() const;
 
     MError Init(MEventLoop *p_event_loop);
     void Clear();
-    MError EnableEvent(int64_t start_time);
+    MError EnableEvent(int64_t start_time, int64_t slack_time = 0);
+    MError EnableNanoEvent(int64_t start_nano_time);
     MError DisableEvent();
 private:
     friend class MEventLoop;
-    void SetLocation(MTimerEventLocation location);
-    MTimerEventLocation GetLocation() const;
+    friend class MTimerWheel;
+    friend class MTimerHeap;
+    void SetHighRes(bool high_res);
+    void SetStartTime(int64_t start_time);
+    void SetExpectTime(int64_t expect_time);
     void SetActived(bool actived);
     void OnCallback();
     virtual void _OnCallback() = 0;
 private:
     MEventLoop *p_event_loop_;
     bool actived_;
-    MTimerEventLocation location_;
+    bool high_res_;
+    int64_t start_time_;
+    int64_t expect_time_;
+    MTimerEventBase *p_next_;
+    MTimerEventBase **pp_prev_;
+    size_t heap_index_;
 };
 
 class MBeforeEventBase
+    :private MEventListHook
 {
-    typedef std::list<MBeforeEventBase*>::iterator MBeforeEventLocation;
 public:
     MBeforeEventBase();
     virtual ~MBeforeEventBase();
@@ -94,20 +128,17 @@ public:
     MError DisableEvent();
 private:
     friend class MEventLoop;
-    void SetLocation(MBeforeEventLocation location);
-    MBeforeEventLocation GetLocation() const;
     void SetActived(bool actived);
     void OnCallback();
     virtual void _OnCallback() = 0;
 private:
     MEventLoop *p_event_loop_;
     bool actived_;
-    MBeforeEventLocation location_;
 };
 
 class MAfterEventBase
+    :private MEventListHook
 {
-    typedef std::list<MAfterEventBase*>::iterator MAfterEventLocation;
 public:
     MAfterEventBase();
     virtual ~MAfterEventBase();
@@ -123,14 +154,11 @@ public:
 private:
     friend class MEventLoop;
     void SetActived(bool actived);
-    void SetLocation(MAfterEventLocation location);
-    MAfterEventLocation GetLocation() const;
     void OnCallback();
     virtual void _OnCallback() = 0;
 private:
     MEventLoop *p_event_loop_;
     bool actived_;
-    MAfterEventLocation location_;
 };
 
 #endif
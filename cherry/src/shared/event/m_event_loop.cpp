@@ -1,13 +1,35 @@
 #include <event/m_event_loop.h>
-#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <util/m_logger.h>
 #include <util/m_time.h>
 #include <unistd.h>
 
+#define MURING_ENTRIES               1024
+#define MURING_USER_DATA_IGNORE      0
+#define MURING_USER_DATA_INTERRUPTER 1
+#define MURING_USER_DATA_TIMER_FD    2
+#define MURING_SLOT_BASE             3
+#define MURING_INVALID_SLOT          static_cast<uint32_t>(-1)
+
 MEventLoop::MEventLoop()
-    :epoll_fd_(-1)
+    :backend_(MEventLoopBackend::Epoll)
+    ,epoll_fd_(-1)
     ,cur_time_(0)
-    ,interrupter_{-1, -1}
+    ,cur_nano_time_(0)
+    ,interrupter_(-1)
+    ,interrupter_fired_(false)
+    ,interrupt_pending_(false)
+    ,change_list_mode_(false)
+    ,saved_ctl_count_(0)
+    ,timer_wakeup_count_(0)
+    ,timer_fd_(-1)
+    ,timer_fd_fired_(false)
+    ,timer_fd_time_(0)
+    ,p_profiler_(nullptr)
+    ,busy_poll_nano_time_(0)
+    ,spin_hit_count_(0)
+    ,spin_miss_count_(0)
 {
 }
 
@@ -16,63 +38,206 @@ MEventLoop::~MEventLoop()
     Clear();
 }
 
-MError MEventLoop::AddInterrupt()
+MError MEventLoop::AddInternalFD(int fd, void *p_tag)
 {
-    if (pipe(interrupter_) != 0)
+    if (backend_ == MEventLoopBackend::IOUring)
     {
-        MLOG(MGetLibLogger(), MERR, "create pipe failed, errno:", errno);
-        return MError::Unknown;
+        uint64_t user_data = p_tag == &interrupter_ ? MURING_USER_DATA_INTERRUPTER : MURING_USER_DATA_TIMER_FD;
+        return io_uring_.PollAdd(fd, EPOLLIN, user_data, true);
     }
-    fcntl(interrupter_[0], F_SETFL, O_NONBLOCK);
-    fcntl(interrupter_[1], F_SETFL, O_NONBLOCK);
     epoll_event ee;
-    ee.events = EPOLLIN | EPOLLERR | EPOLLET;
-    ee.data.ptr = interrupter_;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, interrupter_[0], &ee) == -1)
+    ee.events = EPOLLIN | EPOLLERR;
+    ee.data.ptr = p_tag;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ee) == -1)
     {
         MLOG(MGetLibLogger(), MERR, "epoll ctl failed, errno:", errno);
         return MError::Unknown;
     }
-    int tmp = 1;
-    write(interrupter_[1], &tmp, sizeof(tmp));
     return MError::No;
 }
 
-MError MEventLoop::Init()
+MError MEventLoop::AddInterrupt()
 {
-    if ((epoll_fd_ = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    if ((interrupter_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "create eventfd failed, errno:", errno);
+        return MError::Unknown;
+    }
+    return AddInternalFD(interrupter_, &interrupter_);
+}
+
+MError MEventLoop::AddTimerFD()
+{
+    if ((timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "create timerfd failed, errno:", errno);
+        return MError::Unknown;
+    }
+    return AddInternalFD(timer_fd_, &timer_fd_);
+}
+
+MError MEventLoop::SetTimerFD(int64_t nano_time)
+{
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 0;
+    its.it_value.tv_sec = nano_time / 1000000000;
+    its.it_value.tv_nsec = nano_time % 1000000000;
+    if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "set timerfd failed, errno:", errno);
+        return MError::Unknown;
+    }
+    timer_fd_time_ = nano_time;
+    return MError::No;
+}
+
+MError MEventLoop::Init(MEventLoopBackend backend)
+{
+    backend_ = backend;
+    MError err = MError::No;
+    if (backend_ == MEventLoopBackend::IOUring)
+    {
+        err = io_uring_.Init(MURING_ENTRIES);
+        if (err == MError::NotSupport)
+        {
+            //kernel too old or io_uring disabled on this host, GetBackend reports the fallback
+            MLOG(MGetLibLogger(), MWARN, "io_uring not support, fall back to epoll");
+            backend_ = MEventLoopBackend::Epoll;
+        }
+        else if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "init io_uring failed");
+            return err;
+        }
+        else
+        {
+            uring_cqes_.resize(MURING_ENTRIES);
+        }
+    }
+    if (backend_ == MEventLoopBackend::Epoll && (epoll_fd_ = epoll_create1(EPOLL_CLOEXEC)) == -1)
     {
         MLOG(MGetLibLogger(), MERR, "create epoll failed, errno:", errno);
         return MError::Unknown;
     }
-    MError err = AddInterrupt();
+    err = AddInterrupt();
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = AddTimerFD();
     if (err != MError::No)
     {
         return err;
     }
     UpdateTime();
+    timer_wheel_.Init(cur_time_);
     io_events_.resize(1024);
     return MError::No;
 }
 
 void MEventLoop::Clear()
 {
+    timer_wheel_.Clear();
+    nano_timer_heap_.Clear();
+    for (size_t i = 0; i < uring_slots_.size(); ++i)
+    {
+        if (uring_slots_[i])
+        {
+            uring_slots_[i]->uring_slot_ = MURING_INVALID_SLOT;
+            uring_slots_[i]->uring_user_data_ = 0;
+            uring_slots_[i]->uring_changed_ = false;
+            uring_slots_[i]->SetActived(false);
+        }
+    }
+    uring_slots_.clear();
+    uring_slot_gens_.clear();
+    uring_free_slots_.clear();
+    uring_changes_.clear();
+    uring_removes_.clear();
+    io_uring_.Clear();
+    while (io_changes_.IsLinked())
+    {
+        static_cast<MIOEventBase*>(io_changes_.GetNext())->Unlink();
+    }
     if (epoll_fd_ >= 0)
     {
         close(epoll_fd_);
         epoll_fd_ = -1;
     }
-    if (interrupter_[1] != interrupter_[0]
-        && interrupter_[1] >= 0)
+    if (interrupter_ >= 0)
     {
-        close(interrupter_[1]);
-        interrupter_[1] = -1;
+        close(interrupter_);
+        interrupter_ = -1;
     }
-    if (interrupter_[0] >= 0)
+    if (timer_fd_ >= 0)
     {
-        close(interrupter_[0]);
-        interrupter_[0] = -1;
+        close(timer_fd_);
+        timer_fd_ = -1;
     }
+    interrupter_fired_ = false;
+    timer_fd_fired_ = false;
+    timer_fd_time_ = 0;
+}
+
+MEventLoopBackend MEventLoop::GetBackend() const
+{
+    return backend_;
+}
+
+void MEventLoop::SetChangeListMode(bool enable)
+{
+    if (!enable)
+    {
+        ApplyIOChanges();
+    }
+    change_list_mode_ = enable && backend_ == MEventLoopBackend::Epoll;
+}
+
+bool MEventLoop::IsChangeListMode() const
+{
+    return change_list_mode_;
+}
+
+uint64_t MEventLoop::GetSavedCtlCount() const
+{
+    return saved_ctl_count_;
+}
+
+void MEventLoop::SetBusyPollTime(int64_t nano_time)
+{
+    busy_poll_nano_time_ = std::max(nano_time, static_cast<int64_t>(0));
+}
+
+int64_t MEventLoop::GetBusyPollTime() const
+{
+    return busy_poll_nano_time_;
+}
+
+uint64_t MEventLoop::GetSpinHitCount() const
+{
+    return spin_hit_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t MEventLoop::GetSpinMissCount() const
+{
+    return spin_miss_count_.load(std::memory_order_relaxed);
+}
+
+void MEventLoop::ResetSpinCount()
+{
+    spin_hit_count_.store(0, std::memory_order_relaxed);
+    spin_miss_count_.store(0, std::memory_order_relaxed);
+}
+
+void MEventLoop::SetProfiler(MEventLoopProfiler *p_profiler)
+{
+    p_profiler_ = p_profiler;
+}
+
+MEventLoopProfiler* MEventLoop::GetProfiler() const
+{
+    return p_profiler_;
 }
 
 int64_t MEventLoop::GetTime() const
@@ -80,9 +245,15 @@ int64_t MEventLoop::GetTime() const
     return cur_time_;
 }
 
+int64_t MEventLoop::GetNanoTime() const
+{
+    return cur_nano_time_;
+}
+
 void MEventLoop::UpdateTime()
 {
-    cur_time_ = MTime::GetTime();
+    cur_nano_time_ = MTime::GetMonotonicNanoTime();
+    cur_time_ = cur_nano_time_ / 1000000;
 }
 
 MError MEventLoop::AddIOEvent(unsigned events, MIOEventBase *p_event)
@@ -93,26 +264,56 @@ MError MEventLoop::AddIOEvent(unsigned events, MIOEventBase *p_event)
         return MError::Invalid;
     }
     events |= p_event->GetEvents();
-    if (events & (MIOEVENT_IN | MIOEVENT_OUT | MIOEVENT_RDHUP))
+    if (!(events & (MIOEVENT_IN | MIOEVENT_OUT | MIOEVENT_RDHUP)))
     {
         MLOG(MGetLibLogger(), MERR, "events is not in out or rdhup");
         return MError::Invalid;
     }
-    int op = EPOLL_CTL_ADD;
-    if (p_event->IsActived())
+    if (backend_ == MEventLoopBackend::IOUring)
     {
-        op = EPOLL_CTL_MOD;
+        if (p_event->uring_slot_ == MURING_INVALID_SLOT)
+        {
+            uint32_t slot = 0;
+            if (uring_free_slots_.empty())
+            {
+                slot = static_cast<uint32_t>(uring_slots_.size());
+                uring_slots_.push_back(nullptr);
+                uring_slot_gens_.push_back(1);
+            }
+            else
+            {
+                slot = uring_free_slots_.back();
+                uring_free_slots_.pop_back();
+            }
+            uring_slots_[slot] = p_event;
+            p_event->uring_slot_ = slot;
+        }
+        p_event->SetEvents(events);
+        MarkURingChanged(p_event);
+        p_event->SetActived(true);
+        return MError::No;
     }
-    epoll_event ee;
-    ee.events = events;
-    ee.data.ptr = p_event;
-    if (epoll_ctl(epoll_fd_, op, p_event->GetFD(), &ee) == -1)
+    if (change_list_mode_)
     {
-        MLOG(MGetLibLogger(), MERR, "epoll add failed errno:", errno);
-        return MError::Unknown;
+        if (p_event->IsLinked())
+        {
+            ++saved_ctl_count_;
+        }
+        else
+        {
+            io_changes_.PushBack(p_event);
+        }
+        p_event->SetEvents(events);
+        p_event->SetActived(true);
+        return MError::No;
     }
-    p_event->SetActived(true);
     p_event->SetEvents(events);
+    MError err = ApplyIOChange(p_event);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    p_event->SetActived(true);
     return MError::No;
 }
 
@@ -129,28 +330,85 @@ MError MEventLoop::DelIOEvent(unsigned events, MIOEventBase *p_event)
         p_event->SetEvents(events);
         return MError::No;
     }
-    int op = EPOLL_CTL_DEL;
+    if (backend_ == MEventLoopBackend::IOUring)
+    {
+        p_event->SetEvents(events);
+        if (events & (MIOEVENT_IN | MIOEVENT_OUT | MIOEVENT_RDHUP))
+        {
+            MarkURingChanged(p_event);
+        }
+        else
+        {
+            ReleaseURingSlot(p_event);
+            p_event->SetActived(false);
+        }
+        return MError::No;
+    }
+    p_event->SetEvents(events);
     if (events & (MIOEVENT_IN | MIOEVENT_OUT | MIOEVENT_RDHUP))
     {
-        op = EPOLL_CTL_MOD;
+        if (change_list_mode_)
+        {
+            if (p_event->IsLinked())
+            {
+                ++saved_ctl_count_;
+            }
+            else
+            {
+                io_changes_.PushBack(p_event);
+            }
+            return MError::No;
+        }
+        return ApplyIOChange(p_event);
+    }
+    if (p_event->IsLinked())
+    {
+        p_event->Unlink();
+        ++saved_ctl_count_;
+    }
+    p_event->SetActived(false);
+    if (p_event->applied_events_ == 0)
+    {
+        ++saved_ctl_count_;
+        return MError::No;
     }
     epoll_event ee;
-    ee.events = events;
+    ee.events = 0;
     ee.data.ptr = p_event;
-    if (epoll_ctl(epoll_fd_, op, p_event->GetFD(), &ee) == -1)
+    p_event->applied_events_ = 0;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, p_event->GetFD(), &ee) == -1)
     {
         MLOG(MGetLibLogger(), MERR, "epoll del failed errno:", errno);
         return MError::Unknown;
     }
-    if (op == EPOLL_CTL_DEL)
+    return MError::No;
+}
+
+MError MEventLoop::AddTimerEvent(int64_t start_time, MTimerEventBase *p_event, int64_t slack_time)
+{
+    if (!p_event)
     {
-        p_event->SetActived(false);
+        MLOG(MGetLibLogger(), MERR, "event is Invalid");
+        return MError::Invalid;
     }
-    p_event->SetEvents(events);
+    if (p_event->IsActived())
+    {
+        return MError::No;
+    }
+    p_event->SetHighRes(false);
+    p_event->SetExpectTime(start_time);
+    if (slack_time > 1 && start_time > 0)
+    {
+        int64_t granularity = static_cast<int64_t>(1) << (63 - __builtin_clzll(static_cast<uint64_t>(slack_time)));
+        start_time = (start_time + granularity - 1) & ~(granularity - 1);
+    }
+    p_event->SetStartTime(start_time);
+    timer_wheel_.Add(p_event);
+    p_event->SetActived(true);
     return MError::No;
 }
 
-MError MEventLoop::AddTimerEvent(int64_t start_time, MTimerEventBase *p_event)
+MError MEventLoop::AddNanoTimerEvent(int64_t start_nano_time, MTimerEventBase *p_event)
 {
     if (!p_event)
     {
@@ -161,14 +419,15 @@ MError MEventLoop::AddTimerEvent(int64_t start_time, MTimerEventBase *p_event)
     {
         return MError::No;
     }
-    auto ret = timer_events_.insert(std::make_pair(start_time, p_event));
-    if (!ret.second)
+    p_event->SetHighRes(true);
+    p_event->SetExpectTime(start_nano_time);
+    p_event->SetStartTime(start_nano_time);
+    nano_timer_heap_.Add(p_event);
+    p_event->SetActived(true);
+    if (timer_fd_time_ == 0 || start_nano_time < timer_fd_time_)
     {
-        MLOG(MGetLibLogger(), MERR, "insert timer event failed");
-        return MError::Unknown;
+        return SetTimerFD(std::max(start_nano_time, static_cast<int64_t>(1)));
     }
-    p_event->SetActived(true);
-    p_event->SetLocation(ret.first);
     return MError::No;
 }
 
@@ -183,11 +442,28 @@ MError MEventLoop::DelTimerEvent(MTimerEventBase *p_event)
     {
         return MError::No;
     }
-    timer_events_.erase(p_event->GetLocation());
+    if (p_event->IsHighRes())
+    {
+        nano_timer_heap_.Del(p_event);
+    }
+    else
+    {
+        timer_wheel_.Del(p_event);
+    }
     p_event->SetActived(false);
     return MError::No;
 }
 
+uint64_t MEventLoop::GetTimerWakeupCount() const
+{
+    return timer_wakeup_count_;
+}
+
+uint64_t MEventLoop::GetSavedTimerWakeupCount() const
+{
+    return timer_wheel_.GetSavedWakeupCount();
+}
+
 MError MEventLoop::AddBeforeEvent(MBeforeEventBase *p_event)
 {
     if (!p_event)
@@ -199,10 +475,8 @@ MError MEventLoop::AddBeforeEvent(MBeforeEventBase *p_event)
     {
         return MError::No;
     }
-    before_events_.push_back(p_event);
+    before_events_.PushBack(p_event);
     p_event->SetActived(true);
-    auto iter = before_events_.end();
-    p_event->SetLocation(--iter);
     return MError::No;
 }
 
@@ -217,7 +491,7 @@ MError MEventLoop::DelBeforeEvent(MBeforeEventBase *p_event)
     {
         return MError::No;
     }
-    before_events_.erase(p_event->GetLocation());
+    p_event->Unlink();
     p_event->SetActived(false);
     return MError::No;
 }
@@ -233,10 +507,8 @@ MError MEventLoop::AddAfterEvent(MAfterEventBase *p_event)
     {
         return MError::No;
     }
-    after_events_.push_back(p_event);
+    after_events_.PushBack(p_event);
     p_event->SetActived(true);
-    auto iter = after_events_.end();
-    p_event->SetLocation(--iter);
     return MError::No;
 }
 
@@ -251,19 +523,43 @@ MError MEventLoop::DelAfterEvent(MAfterEventBase *p_event)
     {
         return MError::No;
     }
-    after_events_.erase(p_event->GetLocation());
+    p_event->Unlink();
     p_event->SetActived(false);
     return MError::No;
 }
 
+MError MEventLoop::Post(MInlineFunction<void ()> task)
+{
+    if (!task)
+    {
+        MLOG(MGetLibLogger(), MERR, "task is Invalid");
+        return MError::Invalid;
+    }
+    post_tasks_.Push(std::move(task));
+    return Interrupt();
+}
+
+MError MEventLoop::PostBatch(std::vector<MInlineFunction<void ()> > &tasks)
+{
+    if (tasks.empty())
+    {
+        return MError::No;
+    }
+    post_tasks_.PushBatch(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+    tasks.clear();
+    return Interrupt();
+}
+
 MError MEventLoop::Interrupt()
 {
-    epoll_event ee;
-    ee.events = EPOLLIN | EPOLLERR | EPOLLET;
-    ee.data.ptr = interrupter_[0];
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, interrupter_[0], &ee) == -1)
+    if (interrupt_pending_.exchange(true, std::memory_order_acq_rel))
     {
-        MLOG(MGetLibLogger(), MERR, "epoll ctl failed errno:", errno);
+        return MError::No;
+    }
+    uint64_t one = 1;
+    if (write(interrupter_, &one, sizeof(one)) == -1 && errno != EAGAIN)
+    {
+        MLOG(MGetLibLogger(), MERR, "write eventfd failed errno:", errno);
         return MError::Unknown;
     }
     return MError::No;
@@ -276,32 +572,39 @@ MError MEventLoop::DispatchEvent()
 
 MError MEventLoop::DispatchEventOnce(int timeout)
 {
+    int64_t phase_time = p_profiler_ ? MTime::GetMonotonicNanoTime() : 0;
     MError err = DispatchBeforeEvent();
     if (err != MError::No)
     {
         MLOG(MGetLibLogger(), MERR, "DispatchBeforeEvent failed");
         return err;
     }
+    if (p_profiler_)
+    {
+        p_profiler_->RecordPhase(MEventLoopPhase::Before, phase_time);
+    }
+    int64_t next_tick = 0;
+    bool has_timer = timer_wheel_.GetNextTick(next_tick);
     if (timeout < 0)
     {
-        if (timer_events_.empty())
+        if (!has_timer)
         {
             err = DispatchIOEvent(true, 0);
         }
         else
         {
-            err = DispatchIOEvent(false, timer_events_.begin()->first);
+            err = DispatchIOEvent(false, next_tick);
         }
     }
     else
     {
-        if (timer_events_.empty())
+        if (!has_timer)
         {
             err = DispatchIOEvent(false, cur_time_ + timeout);
         }
         else
         {
-            err = DispatchIOEvent(false, std::min(timer_events_.begin()->first, cur_time_ + timeout));
+            err = DispatchIOEvent(false, std::min(next_tick, cur_time_ + timeout));
         }
     }
     if (err != MError::No)
@@ -309,6 +612,17 @@ MError MEventLoop::DispatchEventOnce(int timeout)
         MLOG(MGetLibLogger(), MERR, "DispatchIOEvent failed");
         return err;
     }
+    phase_time = p_profiler_ ? MTime::GetMonotonicNanoTime() : 0;
+    err = DispatchPostEvent();
+    if (err != MError::No)
+    {
+        MLOG(MGetLibLogger(), MERR, "DispatchPostEvent failed");
+        return err;
+    }
+    if (p_profiler_)
+    {
+        phase_time = p_profiler_->RecordPhase(MEventLoopPhase::Post, phase_time);
+    }
     UpdateTime();
     err = DispatchTimerEvent();
     if (err != MError::No)
@@ -316,27 +630,156 @@ MError MEventLoop::DispatchEventOnce(int timeout)
         MLOG(MGetLibLogger(), MERR, "DispatchTimerEvent failed");
         return err;
     }
+    if (p_profiler_)
+    {
+        phase_time = p_profiler_->RecordPhase(MEventLoopPhase::Timer, phase_time);
+    }
     err = DispatchAfterEvent();
     if (err != MError::No)
     {
         MLOG(MGetLibLogger(), MERR, "DispatchAfterEvent failed");
         return err;
     }
+    if (p_profiler_)
+    {
+        p_profiler_->RecordPhase(MEventLoopPhase::After, phase_time);
+    }
+    return MError::No;
+}
+
+MError MEventLoop::ApplyIOChange(MIOEventBase *p_event)
+{
+    unsigned events = p_event->GetEvents();
+    if (change_list_mode_ && events == p_event->applied_events_ && !(events & MIOEVENT_ONESHOT))
+    {
+        ++saved_ctl_count_;
+        return MError::No;
+    }
+    int op = p_event->applied_events_ == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    epoll_event ee;
+    ee.events = events;
+    ee.data.ptr = p_event;
+    if (epoll_ctl(epoll_fd_, op, p_event->GetFD(), &ee) == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "epoll ctl failed errno:", errno);
+        return MError::Unknown;
+    }
+    p_event->applied_events_ = events;
     return MError::No;
 }
 
+MError MEventLoop::ApplyIOChanges()
+{
+    MError ret = MError::No;
+    while (io_changes_.IsLinked())
+    {
+        MIOEventBase *p_event = static_cast<MIOEventBase*>(io_changes_.GetNext());
+        p_event->Unlink();
+        MError err = ApplyIOChange(p_event);
+        if (err != MError::No)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+int MEventLoop::SpinIOEvent(int &timeout)
+{
+    int64_t spin_time = busy_poll_nano_time_;
+    if (timeout > 0)
+    {
+        spin_time = std::min(spin_time, static_cast<int64_t>(timeout) * 1000000);
+    }
+    int64_t start_time = MTime::GetMonotonicNanoTime();
+    int64_t now_time = start_time;
+    do
+    {
+        int nevents = epoll_wait(epoll_fd_, &io_events_[0], io_events_.size(), 0);
+        if (nevents != 0)
+        {
+            if (nevents > 0)
+            {
+                spin_hit_count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return nevents;
+        }
+        now_time = MTime::GetMonotonicNanoTime();
+    } while (now_time - start_time < spin_time);
+    spin_miss_count_.fetch_add(1, std::memory_order_relaxed);
+    if (timeout > 0)
+    {
+        timeout = std::max(0, timeout - static_cast<int>((now_time - start_time) / 1000000));
+    }
+    return 0;
+}
+
+unsigned MEventLoop::SpinURingEvent(int64_t &timeout)
+{
+    int64_t spin_time = busy_poll_nano_time_;
+    if (timeout > 0)
+    {
+        spin_time = std::min(spin_time, timeout);
+    }
+    int64_t start_time = MTime::GetMonotonicNanoTime();
+    int64_t now_time = start_time;
+    do
+    {
+        io_uring_.Wait(0);
+        unsigned nevents = io_uring_.PeekCQEs(&uring_cqes_[0], static_cast<unsigned>(uring_cqes_.size()));
+        if (nevents > 0)
+        {
+            spin_hit_count_.fetch_add(1, std::memory_order_relaxed);
+            return nevents;
+        }
+        now_time = MTime::GetMonotonicNanoTime();
+    } while (now_time - start_time < spin_time);
+    spin_miss_count_.fetch_add(1, std::memory_order_relaxed);
+    if (timeout > 0)
+    {
+        timeout = std::max(static_cast<int64_t>(0), timeout - (now_time - start_time));
+    }
+    return 0;
+}
+
 MError MEventLoop::DispatchIOEvent(bool forever, int64_t outdate)
 {
+    if (backend_ == MEventLoopBackend::IOUring)
+    {
+        return DispatchURingEvent(forever, outdate);
+    }
     int timeout = -1;
     bool interrupt = false;
     int count = 48;
     do
     {
+        if (io_changes_.IsLinked())
+        {
+            MError err = ApplyIOChanges();
+            if (err != MError::No)
+            {
+                MLOG(MGetLibLogger(), MERR, "apply io changes failed");
+            }
+        }
         if (!forever)
         {
             timeout = std::max(0, static_cast<int>(outdate - cur_time_));
         }
-        int nevents = epoll_wait(epoll_fd_, &io_events_[0], io_events_.size(), timeout);
+        int64_t phase_time = p_profiler_ ? MTime::GetMonotonicNanoTime() : 0;
+        int nevents = 0;
+        if (timeout != 0 && busy_poll_nano_time_ > 0)
+        {
+            nevents = SpinIOEvent(timeout);
+        }
+        if (nevents == 0)
+        {
+            nevents = epoll_wait(epoll_fd_, &io_events_[0], io_events_.size(), timeout);
+        }
+        if (p_profiler_)
+        {
+            phase_time = p_profiler_->RecordPhase(MEventLoopPhase::Wait, phase_time);
+            p_profiler_->RecordIOEvents(nevents);
+        }
         if (nevents == -1)
         {
             if (errno != EINTR)
@@ -354,14 +797,24 @@ MError MEventLoop::DispatchIOEvent(bool forever, int64_t outdate)
                 {
                     continue;
                 }
-                if (p_tmp == interrupter_)
+                if (p_tmp == &interrupter_)
                 {
                     interrupt = true;
+                    interrupter_fired_ = true;
+                    continue;
+                }
+                if (p_tmp == &timer_fd_)
+                {
+                    timer_fd_fired_ = true;
                     continue;
                 }
                 MIOEventBase *p_event = static_cast<MIOEventBase*>(p_tmp);
                 p_event->OnCallback(io_events_[i].events);
             }
+            if (p_profiler_ && nevents > 0)
+            {
+                p_profiler_->RecordPhase(MEventLoopPhase::IO, phase_time);
+            }
         }
         if (interrupt)
         {
@@ -385,56 +838,284 @@ MError MEventLoop::DispatchIOEvent(bool forever, int64_t outdate)
     return MError::No;
 }
 
-MError MEventLoop::DispatchTimerEvent()
+void MEventLoop::MarkURingChanged(MIOEventBase *p_event)
+{
+    if (p_event->uring_changed_)
+    {
+        return;
+    }
+    uint32_t slot = p_event->uring_slot_;
+    uring_changes_.push_back((static_cast<uint64_t>(uring_slot_gens_[slot]) << 32) | slot);
+    p_event->uring_changed_ = true;
+}
+
+void MEventLoop::ReleaseURingSlot(MIOEventBase *p_event)
+{
+    uint32_t slot = p_event->uring_slot_;
+    if (slot == MURING_INVALID_SLOT)
+    {
+        return;
+    }
+    if (p_event->uring_user_data_ != 0)
+    {
+        uring_removes_.push_back(p_event->uring_user_data_);
+    }
+    ++uring_slot_gens_[slot];
+    uring_slots_[slot] = nullptr;
+    uring_free_slots_.push_back(slot);
+    p_event->uring_slot_ = MURING_INVALID_SLOT;
+    p_event->uring_user_data_ = 0;
+    p_event->uring_changed_ = false;
+}
+
+MError MEventLoop::SubmitURingChanges()
 {
-    auto it = timer_events_.begin();
-    while (it != timer_events_.end()
-        && it->first <= cur_time_)
+    MError err = MError::No;
+    for (size_t i = 0; i < uring_removes_.size(); ++i)
     {
-        MTimerEventBase *p_event = it->second;
-        timer_events_.erase(it);
-        if (p_event)
+        if ((err = io_uring_.PollRemove(uring_removes_[i])) != MError::No)
         {
-            p_event->SetActived(false);
-            p_event->OnCallback();
+            return err;
+        }
+    }
+    uring_removes_.clear();
+    for (size_t i = 0; i < uring_changes_.size(); ++i)
+    {
+        uint32_t slot = static_cast<uint32_t>(uring_changes_[i]);
+        uint32_t gen = static_cast<uint32_t>(uring_changes_[i] >> 32);
+        if (slot >= uring_slots_.size() || uring_slot_gens_[slot] != gen || !uring_slots_[slot])
+        {
+            continue;
+        }
+        MIOEventBase *p_event = uring_slots_[slot];
+        p_event->uring_changed_ = false;
+        if (p_event->uring_user_data_ != 0)
+        {
+            if ((err = io_uring_.PollRemove(p_event->uring_user_data_)) != MError::No)
+            {
+                return err;
+            }
         }
-        it = timer_events_.begin();
+        gen = ++uring_slot_gens_[slot];
+        unsigned events = p_event->GetEvents();
+        bool multishot = (events & MIOEVENT_ET) && !(events & MIOEVENT_ONESHOT);
+        uint64_t user_data = (static_cast<uint64_t>(gen) << 32) | (slot + MURING_SLOT_BASE);
+        if ((err = io_uring_.PollAdd(p_event->GetFD(), events & ~(MIOEVENT_ET | MIOEVENT_ONESHOT), user_data, multishot)) != MError::No)
+        {
+            return err;
+        }
+        p_event->uring_user_data_ = user_data;
     }
+    uring_changes_.clear();
     return MError::No;
 }
 
-MError MEventLoop::DispatchBeforeEvent()
+MError MEventLoop::DispatchURingEvent(bool forever, int64_t outdate)
 {
-    std::list<MBeforeEventBase*> events;
-    events.swap(before_events_);
-    auto it = events.begin();
-    while (it != events.end())
+    int64_t timeout = -1;
+    bool interrupt = false;
+    int count = 48;
+    do
     {
-        MBeforeEventBase *p_event = *it;
-        it = events.erase(it);
-        if (p_event)
+        MError err = SubmitURingChanges();
+        if (err != MError::No)
         {
-            p_event->SetActived(false);
-            p_event->OnCallback();
+            return err;
+        }
+        if (!forever)
+        {
+            timeout = std::max(static_cast<int64_t>(0), outdate - cur_time_) * 1000000;
+        }
+        int64_t phase_time = p_profiler_ ? MTime::GetMonotonicNanoTime() : 0;
+        unsigned nevents = 0;
+        if (timeout != 0 && busy_poll_nano_time_ > 0)
+        {
+            nevents = SpinURingEvent(timeout);
         }
+        if (nevents == 0)
+        {
+            err = io_uring_.Wait(timeout);
+            if (err != MError::No && err != MError::Again)
+            {
+                return err;
+            }
+            nevents = io_uring_.PeekCQEs(&uring_cqes_[0], static_cast<unsigned>(uring_cqes_.size()));
+        }
+        if (p_profiler_)
+        {
+            phase_time = p_profiler_->RecordPhase(MEventLoopPhase::Wait, phase_time);
+            p_profiler_->RecordIOEvents(static_cast<int>(nevents));
+        }
+        for (unsigned i = 0; i < nevents; ++i)
+        {
+            const io_uring_cqe &cqe = uring_cqes_[i];
+            bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            if (cqe.user_data == MURING_USER_DATA_IGNORE)
+            {
+                continue;
+            }
+            if ((cqe.user_data == MURING_USER_DATA_INTERRUPTER || cqe.user_data == MURING_USER_DATA_TIMER_FD)
+                && cqe.res < 0)
+            {
+                //re-arming a poll the kernel rejects would spin
+                MLOG(MGetLibLogger(), MERR, "poll internal fd failed, user_data:", cqe.user_data, " res:", cqe.res);
+                return MError::Unknown;
+            }
+            if (cqe.user_data == MURING_USER_DATA_INTERRUPTER)
+            {
+                interrupt = true;
+                interrupter_fired_ = true;
+                if (!more && (err = AddInternalFD(interrupter_, &interrupter_)) != MError::No)
+                {
+                    return err;
+                }
+                continue;
+            }
+            if (cqe.user_data == MURING_USER_DATA_TIMER_FD)
+            {
+                timer_fd_fired_ = true;
+                if (!more && (err = AddInternalFD(timer_fd_, &timer_fd_)) != MError::No)
+                {
+                    return err;
+                }
+                continue;
+            }
+            uint32_t slot = static_cast<uint32_t>(cqe.user_data) - MURING_SLOT_BASE;
+            uint32_t gen = static_cast<uint32_t>(cqe.user_data >> 32);
+            if (slot >= uring_slots_.size() || uring_slot_gens_[slot] != gen || !uring_slots_[slot])
+            {
+                continue;
+            }
+            MIOEventBase *p_event = uring_slots_[slot];
+            if (!more)
+            {
+                p_event->uring_user_data_ = 0;
+                if (!(p_event->GetEvents() & MIOEVENT_ONESHOT))
+                {
+                    MarkURingChanged(p_event);
+                }
+            }
+            if (cqe.res == -ECANCELED)
+            {
+                continue;
+            }
+            p_event->OnCallback(cqe.res < 0 ? MIOEVENT_ERR : static_cast<unsigned>(cqe.res));
+        }
+        if (p_profiler_ && nevents > 0)
+        {
+            p_profiler_->RecordPhase(MEventLoopPhase::IO, phase_time);
+        }
+        if (interrupt)
+        {
+            break;
+        }
+        if (nevents > 0)
+        {
+            if (nevents == uring_cqes_.size() && (--count > 0))
+            {
+                outdate = cur_time_;
+                forever = false;
+                continue;
+            }
+            break;
+        }
+        UpdateTime();
+        if (!forever && (outdate <= cur_time_))
+        {
+            break;
+        }
+    } while (true);
+    return MError::No;
+}
+
+MError MEventLoop::DispatchPostEvent()
+{
+    //a producer may write after the flag was cleared, the eventfd is level triggered and must be read
+    //whenever it fired or every later wait returns at once
+    if (interrupter_fired_)
+    {
+        uint64_t count = 0;
+        if (read(interrupter_, &count, sizeof(count)) == -1 && errno != EAGAIN)
+        {
+            MLOG(MGetLibLogger(), MERR, "read eventfd failed errno:", errno);
+            return MError::Unknown;
+        }
+        interrupter_fired_ = false;
+    }
+    //cleared before draining, a producer that still sees it set is drained below
+    if (!interrupt_pending_.exchange(false, std::memory_order_acq_rel))
+    {
+        return MError::No;
+    }
+    MInlineFunction<void ()> task;
+    while (post_tasks_.Pop(task))
+    {
+        task();
     }
     return MError::No;
 }
 
-MError MEventLoop::DispatchAfterEvent()
+MError MEventLoop::DispatchTimerEvent()
 {
-    std::list<MAfterEventBase*> events;
-    events.swap(after_events_);
-    auto it = events.begin();
-    while (it != events.end())
+    if (timer_wheel_.Expire(cur_time_) > 0)
+    {
+        ++timer_wakeup_count_;
+    }
+    if (timer_fd_fired_)
     {
-        MAfterEventBase *p_event = *it;
-        it = events.erase(it);
-        if (p_event)
+        uint64_t count = 0;
+        if (read(timer_fd_, &count, sizeof(count)) == -1 && errno != EAGAIN)
         {
-            p_event->SetActived(false);
-            p_event->OnCallback();
+            MLOG(MGetLibLogger(), MERR, "read timerfd failed errno:", errno);
+            return MError::Unknown;
+        }
+        timer_fd_fired_ = false;
+        timer_fd_time_ = 0;
+    }
+    if (nano_timer_heap_.Empty())
+    {
+        return MError::No;
+    }
+    nano_timer_heap_.Expire(MTime::GetMonotonicNanoTime());
+    int64_t next_time = 0;
+    if (nano_timer_heap_.GetNextTime(next_time))
+    {
+        if (next_time != timer_fd_time_)
+        {
+            return SetTimerFD(std::max(next_time, static_cast<int64_t>(1)));
         }
     }
+    else if (timer_fd_time_ != 0)
+    {
+        return SetTimerFD(0);
+    }
+    return MError::No;
+}
+
+MError MEventLoop::DispatchBeforeEvent()
+{
+    MEventListHook events;
+    events.Splice(before_events_);
+    while (events.IsLinked())
+    {
+        MBeforeEventBase *p_event = static_cast<MBeforeEventBase*>(events.GetNext());
+        p_event->Unlink();
+        p_event->SetActived(false);
+        p_event->OnCallback();
+    }
+    return MError::No;
+}
+
+MError MEventLoop::DispatchAfterEvent()
+{
+    MEventListHook events;
+    events.Splice(after_events_);
+    while (events.IsLinked())
+    {
+        MAfterEventBase *p_event = static_cast<MAfterEventBase*>(events.GetNext());
+        p_event->Unlink();
+        p_event->SetActived(false);
+        p_event->OnCallback();
+    }
     return MError::No;
 }
@@ -1,17 +1,24 @@
 #ifndef _M_EVENT_LOOP_H_
 #define _M_EVENT_LOOP_H_
 
-#include <map>
 #include <vector>
-#include <list>
+#include <atomic>
+#include <util/m_inline_function.h>
 #include <util/m_errno.h>
 #include <util/m_type_define.h>
 #include <sys/epoll.h>
 #include <event/m_event_base.h>
+#include <event/m_timer_wheel.h>
+#include <event/m_timer_heap.h>
+#include <event/m_io_uring.h>
+#include <event/m_event_loop_profiler.h>
+#include <util/m_mpsc_queue.h>
 
-typedef std::multimap<int64_t, MTimerEventBase*>::iterator MTimerEventLocation;
-typedef std::list<MBeforeEventBase*>::iterator MBeforeEventLocation;
-typedef std::list<MAfterEventBase*>::iterator MAfterEventLocation;
+enum class MEventLoopBackend
+{
+    Epoll = 0,
+    IOUring = 1,
+};
 
 class MEventLoop
 {
@@ -21,17 +28,35 @@ public:
     MEventLoop(const MEventLoop &) = delete;
     MEventLoop& operator=(const MEventLoop &) = delete;
 public:
-    MError Init();
+    MError Init(MEventLoopBackend backend = MEventLoopBackend::Epoll);
     void Clear();
+    MEventLoopBackend GetBackend() const;
+
+    void SetChangeListMode(bool enable);
+    bool IsChangeListMode() const;
+    uint64_t GetSavedCtlCount() const;
+
+    void SetBusyPollTime(int64_t nano_time);
+    int64_t GetBusyPollTime() const;
+    uint64_t GetSpinHitCount() const;
+    uint64_t GetSpinMissCount() const;
+    void ResetSpinCount();
+
+    void SetProfiler(MEventLoopProfiler *p_profiler);
+    MEventLoopProfiler* GetProfiler() const;
 
     int64_t GetTime() const;
+    int64_t GetNanoTime() const;
     void UpdateTime();
 
     MError AddIOEvent(unsigned events, MIOEventBase *p_event);
     MError DelIOEvent(unsigned events, MIOEventBase *p_event);
 
-    MError AddTimerEvent(int64_t start_time, MTimerEventBase *p_event);
+    MError AddTimerEvent(int64_t start_time, MTimerEventBase *p_event, int64_t slack_time = 0);
+    MError AddNanoTimerEvent(int64_t start_nano_time, MTimerEventBase *p_event);
     MError DelTimerEvent(MTimerEventBase *p_event);
+    uint64_t GetTimerWakeupCount() const;
+    uint64_t GetSavedTimerWakeupCount() const;
 
     MError AddBeforeEvent(MBeforeEventBase *p_event);
     MError DelBeforeEvent(MBeforeEventBase *p_event);
@@ -39,23 +64,62 @@ public:
     MError AddAfterEvent(MAfterEventBase *p_event);
     MError DelAfterEvent(MAfterEventBase *p_event);
 
+    MError Post(MInlineFunction<void ()> task);
+    MError PostBatch(std::vector<MInlineFunction<void ()> > &tasks);
+
     MError Interrupt();
     MError DispatchEvent();
     MError DispatchEventOnce(int timeout = -1);
 private:
+    MError AddInternalFD(int fd, void *p_tag);
     MError AddInterrupt();
+    MError AddTimerFD();
+    MError SetTimerFD(int64_t nano_time);
+    MError ApplyIOChange(MIOEventBase *p_event);
+    MError ApplyIOChanges();
+    int SpinIOEvent(int &timeout);
+    unsigned SpinURingEvent(int64_t &timeout);
     MError DispatchIOEvent(bool forever, int64_t outdate);
+    MError DispatchURingEvent(bool forever, int64_t outdate);
+    void MarkURingChanged(MIOEventBase *p_event);
+    void ReleaseURingSlot(MIOEventBase *p_event);
+    MError SubmitURingChanges();
+    MError DispatchPostEvent();
     MError DispatchTimerEvent();
     MError DispatchBeforeEvent();
     MError DispatchAfterEvent();
 private:
+    MEventLoopBackend backend_;
     int epoll_fd_;
     int64_t cur_time_;
-    int interrupter_[2];
+    int64_t cur_nano_time_;
+    int interrupter_;
+    bool interrupter_fired_;
+    std::atomic<bool> interrupt_pending_;
+    MMpscQueue<MInlineFunction<void ()> > post_tasks_;
     std::vector<epoll_event> io_events_;
-    std::multimap<int64_t, MTimerEventBase*> timer_events_;
-    std::list<MBeforeEventBase*> before_events_;
-    std::list<MAfterEventBase*> after_events_;
+    bool change_list_mode_;
+    MEventListHook io_changes_;
+    uint64_t saved_ctl_count_;
+    MIOURing io_uring_;
+    std::vector<io_uring_cqe> uring_cqes_;
+    std::vector<MIOEventBase*> uring_slots_;
+    std::vector<uint32_t> uring_slot_gens_;
+    std::vector<uint32_t> uring_free_slots_;
+    std::vector<uint64_t> uring_changes_;
+    std::vector<uint64_t> uring_removes_;
+    MTimerWheel timer_wheel_;
+    uint64_t timer_wakeup_count_;
+    int timer_fd_;
+    bool timer_fd_fired_;
+    int64_t timer_fd_time_;
+    MTimerHeap nano_timer_heap_;
+    MEventListHook before_events_;
+    MEventListHook after_events_;
+    MEventLoopProfiler *p_profiler_;
+    int64_t busy_poll_nano_time_;
+    std::atomic<uint64_t> spin_hit_count_;
+    std::atomic<uint64_t> spin_miss_count_;
 };
 
 #endif
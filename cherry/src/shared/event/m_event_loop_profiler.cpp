@@ -0,0 +1,121 @@
+#include <event/m_event_loop_profiler.h>
+#include <util/m_logger.h>
+#include <util/m_time.h>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <sstream>
+
+static const char* sg_phase_names[] =
+{
+    "before",
+    "wait",
+    "io",
+    "post",
+    "timer",
+    "after",
+};
+
+MEventLoopProfiler::MEventLoopProfiler(int64_t slow_callback_nano_time)
+    :slow_callback_nano_time_(slow_callback_nano_time)
+    ,slow_callback_count_(0)
+{
+}
+
+MEventLoopProfiler::~MEventLoopProfiler()
+{
+}
+
+void MEventLoopProfiler::SetSlowCallbackTime(int64_t nano_time)
+{
+    slow_callback_nano_time_ = nano_time;
+}
+
+int64_t MEventLoopProfiler::GetSlowCallbackTime() const
+{
+    return slow_callback_nano_time_;
+}
+
+void MEventLoopProfiler::Reset()
+{
+    for (auto &histogram : phase_histograms_)
+    {
+        histogram.Reset();
+    }
+    io_events_histogram_.Reset();
+    timer_lateness_histogram_.Reset();
+    slow_callback_count_ = 0;
+}
+
+const MHistogram& MEventLoopProfiler::GetPhaseHistogram(MEventLoopPhase phase) const
+{
+    return phase_histograms_[static_cast<int>(phase)];
+}
+
+const MHistogram& MEventLoopProfiler::GetIOEventsHistogram() const
+{
+    return io_events_histogram_;
+}
+
+const MHistogram& MEventLoopProfiler::GetTimerLatenessHistogram() const
+{
+    return timer_lateness_histogram_;
+}
+
+uint64_t MEventLoopProfiler::GetSlowCallbackCount() const
+{
+    return slow_callback_count_;
+}
+
+std::string MEventLoopProfiler::Dump() const
+{
+    std::stringstream ss;
+    for (int i = 0; i < static_cast<int>(MEventLoopPhase::Count); ++i)
+    {
+        const MHistogram &histogram = phase_histograms_[i];
+        ss << sg_phase_names[i] << "(ns) count:" << histogram.GetCount()
+            << " mean:" << histogram.GetMean()
+            << " p50:" << histogram.GetPercentile(50)
+            << " p99:" << histogram.GetPercentile(99)
+            << " max:" << histogram.GetMax() << "\n";
+    }
+    ss << "events/wait count:" << io_events_histogram_.GetCount()
+        << " mean:" << io_events_histogram_.GetMean()
+        << " max:" << io_events_histogram_.GetMax() << "\n";
+    ss << "timer lateness(ns) count:" << timer_lateness_histogram_.GetCount()
+        << " p50:" << timer_lateness_histogram_.GetPercentile(50)
+        << " p99:" << timer_lateness_histogram_.GetPercentile(99)
+        << " max:" << timer_lateness_histogram_.GetMax() << "\n";
+    ss << "slow callback count:" << slow_callback_count_ << "\n";
+    return ss.str();
+}
+
+int64_t MEventLoopProfiler::RecordPhase(MEventLoopPhase phase, int64_t start_nano_time)
+{
+    int64_t now_nano_time = MTime::GetMonotonicNanoTime();
+    phase_histograms_[static_cast<int>(phase)].Record(now_nano_time - start_nano_time);
+    return now_nano_time;
+}
+
+void MEventLoopProfiler::RecordIOEvents(int count)
+{
+    io_events_histogram_.Record(count);
+}
+
+void MEventLoopProfiler::RecordTimerLateness(int64_t nano_time)
+{
+    timer_lateness_histogram_.Record(nano_time);
+}
+
+void MEventLoopProfiler::RecordCallback(const char *p_type_name, int64_t cost_nano_time)
+{
+    if (slow_callback_nano_time_ <= 0 || cost_nano_time < slow_callback_nano_time_)
+    {
+        return;
+    }
+    ++slow_callback_count_;
+    int status = 0;
+    char *p_demangled = abi::__cxa_demangle(p_type_name, nullptr, nullptr, &status);
+    MLOG(MGetLibLogger(), MWARN, "slow callback type:", (status == 0 && p_demangled) ? p_demangled : p_type_name
+        , " cost(ns):", cost_nano_time, " budget(ns):", slow_callback_nano_time_);
+    free(p_demangled);
+}
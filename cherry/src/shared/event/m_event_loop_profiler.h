@@ -0,0 +1,49 @@
+#ifndef _M_EVENT_LOOP_PROFILER_H_
+#define _M_EVENT_LOOP_PROFILER_H_
+
+#include <util/m_histogram.h>
+#include <util/m_type_define.h>
+#include <string>
+
+enum class MEventLoopPhase
+{
+    Before = 0,
+    Wait = 1,
+    IO = 2,
+    Post = 3,
+    Timer = 4,
+    After = 5,
+    Count = 6,
+};
+
+class MEventLoopProfiler
+{
+public:
+    explicit MEventLoopProfiler(int64_t slow_callback_nano_time = 0);
+    ~MEventLoopProfiler();
+    MEventLoopProfiler(const MEventLoopProfiler &) = delete;
+    MEventLoopProfiler& operator=(const MEventLoopProfiler &) = delete;
+public:
+    void SetSlowCallbackTime(int64_t nano_time);
+    int64_t GetSlowCallbackTime() const;
+    void Reset();
+
+    const MHistogram& GetPhaseHistogram(MEventLoopPhase phase) const;
+    const MHistogram& GetIOEventsHistogram() const;
+    const MHistogram& GetTimerLatenessHistogram() const;
+    uint64_t GetSlowCallbackCount() const;
+    std::string Dump() const;
+
+    int64_t RecordPhase(MEventLoopPhase phase, int64_t start_nano_time);
+    void RecordIOEvents(int count);
+    void RecordTimerLateness(int64_t nano_time);
+    void RecordCallback(const char *p_type_name, int64_t cost_nano_time);
+private:
+    int64_t slow_callback_nano_time_;
+    MHistogram phase_histograms_[static_cast<int>(MEventLoopPhase::Count)];
+    MHistogram io_events_histogram_;
+    MHistogram timer_lateness_histogram_;
+    uint64_t slow_callback_count_;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include <event/m_frame_scheduler.h>
+#include <util/m_time.h>
+
+MFrameScheduler::MFrameScheduler()
+    :p_event_loop_(nullptr)
+    ,running_(false)
+    ,frame_rate_(0)
+    ,max_catch_up_frames_(0)
+    ,frame_budget_(0)
+    ,explicit_budget_(false)
+    ,min_spare_time_(0)
+    ,start_time_(0)
+    ,frame_index_(0)
+    ,frame_count_(0)
+    ,overrun_count_(0)
+    ,skipped_frame_count_(0)
+{
+}
+
+MFrameScheduler::~MFrameScheduler()
+{
+    Clear();
+}
+
+MError MFrameScheduler::Init(MEventLoop *p_event_loop)
+{
+    if (!p_event_loop)
+    {
+        return MError::Invalid;
+    }
+    MError err = this->MTimerEventBase::Init(p_event_loop);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    p_event_loop_ = p_event_loop;
+    return MError::No;
+}
+
+void MFrameScheduler::Clear()
+{
+    this->MTimerEventBase::Clear();
+}
+
+MError MFrameScheduler::Start(MInlineFunction<void ()> frame_cb, int frame_rate, int max_catch_up_frames)
+{
+    if (!frame_cb || frame_rate <= 0 || frame_rate > 1000 || max_catch_up_frames < 0)
+    {
+        return MError::Invalid;
+    }
+    MError err = Stop();
+    if (err != MError::No)
+    {
+        return err;
+    }
+    frame_cb_ = std::move(frame_cb);
+    frame_rate_ = frame_rate;
+    max_catch_up_frames_ = max_catch_up_frames;
+    if (!explicit_budget_)
+    {
+        frame_budget_ = GetFrameNanoTime();
+    }
+    start_time_ = MTime::GetMonotonicNanoTime();
+    frame_index_ = 0;
+    running_ = true;
+    return this->MTimerEventBase::EnableNanoEvent(start_time_);
+}
+
+MError MFrameScheduler::Stop()
+{
+    running_ = false;
+    return this->MTimerEventBase::DisableEvent();
+}
+
+bool MFrameScheduler::IsRunning() const
+{
+    return running_;
+}
+
+void MFrameScheduler::SetFrameBudget(int64_t nano_time)
+{
+    explicit_budget_ = nano_time > 0;
+    frame_budget_ = explicit_budget_ ? nano_time : GetFrameNanoTime();
+}
+
+int64_t MFrameScheduler::GetFrameBudget() const
+{
+    return frame_budget_;
+}
+
+void MFrameScheduler::SetSpareCallback(MInlineFunction<void (int64_t)> spare_cb, int64_t min_spare_nano_time)
+{
+    spare_cb_ = std::move(spare_cb);
+    min_spare_time_ = min_spare_nano_time;
+}
+
+int MFrameScheduler::GetFrameRate() const
+{
+    return frame_rate_;
+}
+
+int64_t MFrameScheduler::GetFrameNanoTime() const
+{
+    return frame_rate_ > 0 ? 1000000000 / frame_rate_ : 0;
+}
+
+uint64_t MFrameScheduler::GetFrameCount() const
+{
+    return frame_count_;
+}
+
+uint64_t MFrameScheduler::GetOverrunCount() const
+{
+    return overrun_count_;
+}
+
+uint64_t MFrameScheduler::GetSkippedFrameCount() const
+{
+    return skipped_frame_count_;
+}
+
+const MHistogram& MFrameScheduler::GetFrameCostHistogram() const
+{
+    return frame_cost_histogram_;
+}
+
+const MHistogram& MFrameScheduler::GetFrameLatenessHistogram() const
+{
+    return frame_lateness_histogram_;
+}
+
+void MFrameScheduler::ResetStats()
+{
+    frame_count_ = 0;
+    overrun_count_ = 0;
+    skipped_frame_count_ = 0;
+    frame_cost_histogram_.Reset();
+    frame_lateness_histogram_.Reset();
+}
+
+int64_t MFrameScheduler::GetFrameTime(int64_t frame_index) const
+{
+    return start_time_ + frame_index / frame_rate_ * 1000000000
+        + frame_index % frame_rate_ * 1000000000 / frame_rate_;
+}
+
+void MFrameScheduler::_OnCallback()
+{
+    int64_t now_time = MTime::GetMonotonicNanoTime();
+    int catch_up = 0;
+    while (true)
+    {
+        frame_lateness_histogram_.Record(now_time - GetFrameTime(frame_index_));
+        frame_cb_();
+        if (!running_)
+        {
+            return;
+        }
+        int64_t end_time = MTime::GetMonotonicNanoTime();
+        int64_t cost = end_time - now_time;
+        frame_cost_histogram_.Record(cost);
+        if (cost > frame_budget_)
+        {
+            ++overrun_count_;
+        }
+        ++frame_count_;
+        ++frame_index_;
+        now_time = end_time;
+        if (GetFrameTime(frame_index_) > now_time)
+        {
+            break;
+        }
+        if (++catch_up > max_catch_up_frames_)
+        {
+            int64_t behind = (now_time - GetFrameTime(frame_index_)) * frame_rate_ / 1000000000 + 1;
+            skipped_frame_count_ += behind;
+            frame_index_ += behind;
+            break;
+        }
+    }
+    int64_t next_time = GetFrameTime(frame_index_);
+    if (spare_cb_ && next_time - now_time >= min_spare_time_)
+    {
+        spare_cb_(next_time - now_time);
+        if (!running_)
+        {
+            return;
+        }
+    }
+    this->MTimerEventBase::EnableNanoEvent(next_time);
+}
@@ -0,0 +1,60 @@
+#ifndef _M_FRAME_SCHEDULER_H_
+#define _M_FRAME_SCHEDULER_H_
+
+#include <util/m_errno.h>
+#include <util/m_type_define.h>
+#include <util/m_histogram.h>
+#include <event/m_event_loop.h>
+#include <util/m_inline_function.h>
+
+class MFrameScheduler
+    :public MTimerEventBase
+{
+public:
+    MFrameScheduler();
+    virtual ~MFrameScheduler();
+    MFrameScheduler(const MFrameScheduler &) = delete;
+    MFrameScheduler& operator=(const MFrameScheduler &) = delete;
+public:
+    MError Init(MEventLoop *p_event_loop);
+    void Clear();
+    MError Start(MInlineFunction<void ()> frame_cb, int frame_rate, int max_catch_up_frames = 5);
+    MError Stop();
+    bool IsRunning() const;
+
+    //kept across Start, <= 0 goes back to one frame interval of the current rate
+    void SetFrameBudget(int64_t nano_time);
+    int64_t GetFrameBudget() const;
+    void SetSpareCallback(MInlineFunction<void (int64_t)> spare_cb, int64_t min_spare_nano_time = 1000000);
+    int GetFrameRate() const;
+    int64_t GetFrameNanoTime() const;
+
+    uint64_t GetFrameCount() const;
+    uint64_t GetOverrunCount() const;
+    uint64_t GetSkippedFrameCount() const;
+    const MHistogram& GetFrameCostHistogram() const;
+    const MHistogram& GetFrameLatenessHistogram() const;
+    void ResetStats();
+private:
+    int64_t GetFrameTime(int64_t frame_index) const;
+    virtual void _OnCallback() override;
+private:
+    MEventLoop *p_event_loop_;
+    MInlineFunction<void ()> frame_cb_;
+    MInlineFunction<void (int64_t)> spare_cb_;
+    bool running_;
+    int frame_rate_;
+    int max_catch_up_frames_;
+    int64_t frame_budget_;
+    bool explicit_budget_;
+    int64_t min_spare_time_;
+    int64_t start_time_;
+    int64_t frame_index_;
+    uint64_t frame_count_;
+    uint64_t overrun_count_;
+    uint64_t skipped_frame_count_;
+    MHistogram frame_cost_histogram_;
+    MHistogram frame_lateness_histogram_;
+};
+
+#endif
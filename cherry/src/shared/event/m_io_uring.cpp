@@ -0,0 +1,344 @@
+#include <event/m_io_uring.h>
+#include <util/m_logger.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+#include <ctime>
+
+#define MIOURING_PROBE_USER_DATA static_cast<uint64_t>(-1)
+#define MIOURING_PROBE_AGAIN_COUNT 100
+
+MIOURing::MIOURing()
+    :ring_fd_(-1)
+    ,p_sq_ring_(nullptr)
+    ,sq_ring_size_(0)
+    ,p_cq_ring_(nullptr)
+    ,cq_ring_size_(0)
+    ,p_sqes_(nullptr)
+    ,sqes_size_(0)
+    ,p_sq_head_(nullptr)
+    ,p_sq_tail_(nullptr)
+    ,p_sq_array_(nullptr)
+    ,sq_mask_(0)
+    ,sq_entries_(0)
+    ,sq_tail_(0)
+    ,sq_pending_(0)
+    ,p_cq_head_(nullptr)
+    ,p_cq_tail_(nullptr)
+    ,cq_mask_(0)
+    ,p_cqes_(nullptr)
+{
+}
+
+MIOURing::~MIOURing()
+{
+    Clear();
+}
+
+MError MIOURing::Init(unsigned entries)
+{
+    if (ring_fd_ >= 0)
+    {
+        return MError::Created;
+    }
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0)
+    {
+        int setup_errno = errno;
+        MLOG(MGetLibLogger(), MERR, "io_uring setup failed, errno:", setup_errno);
+        ring_fd_ = -1;
+        //ENOSYS old kernel, EPERM io_uring_disabled sysctl or seccomp, EINVAL unsupported setup flags
+        if (setup_errno == ENOSYS || setup_errno == EPERM || setup_errno == EINVAL)
+        {
+            return MError::NotSupport;
+        }
+        return MError::Unknown;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG)
+        || !(params.features & IORING_FEAT_NODROP))
+    {
+        MLOG(MGetLibLogger(), MERR, "io_uring features not support:", params.features);
+        Clear();
+        return MError::NotSupport;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (cq_ring_size_ > sq_ring_size_)
+        {
+            sq_ring_size_ = cq_ring_size_;
+        }
+        cq_ring_size_ = sq_ring_size_;
+    }
+    p_sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (p_sq_ring_ == MAP_FAILED)
+    {
+        MLOG(MGetLibLogger(), MERR, "mmap sq ring failed, errno:", errno);
+        p_sq_ring_ = nullptr;
+        Clear();
+        return MError::Unknown;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        p_cq_ring_ = p_sq_ring_;
+    }
+    else
+    {
+        p_cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (p_cq_ring_ == MAP_FAILED)
+        {
+            MLOG(MGetLibLogger(), MERR, "mmap cq ring failed, errno:", errno);
+            p_cq_ring_ = nullptr;
+            Clear();
+            return MError::Unknown;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *p_sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (p_sqes == MAP_FAILED)
+    {
+        MLOG(MGetLibLogger(), MERR, "mmap sqes failed, errno:", errno);
+        Clear();
+        return MError::Unknown;
+    }
+    p_sqes_ = static_cast<io_uring_sqe*>(p_sqes);
+    char *p_sq = static_cast<char*>(p_sq_ring_);
+    p_sq_head_ = reinterpret_cast<unsigned*>(p_sq + params.sq_off.head);
+    p_sq_tail_ = reinterpret_cast<unsigned*>(p_sq + params.sq_off.tail);
+    p_sq_array_ = reinterpret_cast<unsigned*>(p_sq + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(p_sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_tail_ = *p_sq_tail_;
+    sq_pending_ = 0;
+    char *p_cq = static_cast<char*>(p_cq_ring_);
+    p_cq_head_ = reinterpret_cast<unsigned*>(p_cq + params.cq_off.head);
+    p_cq_tail_ = reinterpret_cast<unsigned*>(p_cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(p_cq + params.cq_off.ring_mask);
+    p_cqes_ = reinterpret_cast<io_uring_cqe*>(p_cq + params.cq_off.cqes);
+    if (!ProbeMultishotPoll())
+    {
+        MLOG(MGetLibLogger(), MERR, "io_uring multishot poll not support");
+        Clear();
+        return MError::NotSupport;
+    }
+    return MError::No;
+}
+
+void MIOURing::Clear()
+{
+    if (p_sqes_)
+    {
+        munmap(p_sqes_, sqes_size_);
+        p_sqes_ = nullptr;
+    }
+    if (p_cq_ring_ && p_cq_ring_ != p_sq_ring_)
+    {
+        munmap(p_cq_ring_, cq_ring_size_);
+    }
+    p_cq_ring_ = nullptr;
+    if (p_sq_ring_)
+    {
+        munmap(p_sq_ring_, sq_ring_size_);
+        p_sq_ring_ = nullptr;
+    }
+    if (ring_fd_ >= 0)
+    {
+        close(ring_fd_);
+        ring_fd_ = -1;
+    }
+    sq_pending_ = 0;
+}
+
+bool MIOURing::IsInited() const
+{
+    return ring_fd_ >= 0;
+}
+
+io_uring_sqe* MIOURing::GetSQE()
+{
+    if (sq_tail_ - __atomic_load_n(p_sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+    {
+        if (Submit() != MError::No)
+        {
+            return nullptr;
+        }
+    }
+    unsigned index = sq_tail_ & sq_mask_;
+    io_uring_sqe *p_sqe = &p_sqes_[index];
+    memset(p_sqe, 0, sizeof(*p_sqe));
+    p_sq_array_[index] = index;
+    ++sq_tail_;
+    ++sq_pending_;
+    return p_sqe;
+}
+
+bool MIOURing::ProbeMultishotPoll()
+{
+    int fd = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "create eventfd failed, errno:", errno);
+        return false;
+    }
+    bool supported = false;
+    bool done = false;
+    bool removed = false;
+    int again_count = 0;
+    io_uring_cqe cqe;
+    if (PollAdd(fd, POLLIN, MIOURING_PROBE_USER_DATA, true) != MError::No)
+    {
+        close(fd);
+        return false;
+    }
+    //the eventfd is readable, so the poll completes at once, with F_MORE only if it stays armed
+    while (!done)
+    {
+        //EAGAIN only means the kernel is short of memory for now, not that the poll is unsupported
+        MError err = Wait(-1);
+        if (err == MError::Again && ++again_count <= MIOURING_PROBE_AGAIN_COUNT)
+        {
+            usleep(1000);
+            continue;
+        }
+        if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "io_uring probe wait failed err:", static_cast<int>(err));
+            break;
+        }
+        while (PeekCQEs(&cqe, 1) == 1)
+        {
+            if (cqe.user_data != MIOURING_PROBE_USER_DATA)
+            {
+                continue;
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE))
+            {
+                if (!removed)
+                {
+                    MLOG(MGetLibLogger(), MERR, "io_uring multishot poll ended at once, res:", cqe.res);
+                }
+                done = true;
+                break;
+            }
+            supported = cqe.res >= 0;
+            if (!removed)
+            {
+                removed = PollRemove(MIOURING_PROBE_USER_DATA) == MError::No;
+                if (!removed)
+                {
+                    done = true;
+                    break;
+                }
+            }
+        }
+    }
+    close(fd);
+    return done && supported;
+}
+
+MError MIOURing::PollAdd(int fd, unsigned events, uint64_t user_data, bool multishot)
+{
+    io_uring_sqe *p_sqe = GetSQE();
+    if (!p_sqe)
+    {
+        return MError::Unknown;
+    }
+    p_sqe->opcode = IORING_OP_POLL_ADD;
+    p_sqe->fd = fd;
+    p_sqe->poll32_events = events;
+    p_sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+    p_sqe->user_data = user_data;
+    return MError::No;
+}
+
+MError MIOURing::PollRemove(uint64_t target_user_data)
+{
+    io_uring_sqe *p_sqe = GetSQE();
+    if (!p_sqe)
+    {
+        return MError::Unknown;
+    }
+    p_sqe->opcode = IORING_OP_POLL_REMOVE;
+    p_sqe->fd = -1;
+    p_sqe->addr = target_user_data;
+    p_sqe->user_data = 0;
+    return MError::No;
+}
+
+MError MIOURing::Enter(unsigned min_complete, unsigned flags, const void *p_arg, size_t arg_size)
+{
+    __atomic_store_n(p_sq_tail_, sq_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sq_pending_;
+    while (true)
+    {
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, p_arg, arg_size));
+        if (ret >= 0)
+        {
+            sq_pending_ -= static_cast<unsigned>(ret) < to_submit ? static_cast<unsigned>(ret) : to_submit;
+            return MError::No;
+        }
+        if (errno == ETIME || errno == EINTR)
+        {
+            sq_pending_ = 0;
+            return MError::No;
+        }
+        if (errno == EAGAIN || errno == EBUSY)
+        {
+            return MError::Again;
+        }
+        MLOG(MGetLibLogger(), MERR, "io_uring enter failed, errno:", errno);
+        return MError::Unknown;
+    }
+}
+
+MError MIOURing::Submit()
+{
+    if (sq_pending_ == 0)
+    {
+        return MError::No;
+    }
+    return Enter(0, 0, nullptr, 0);
+}
+
+MError MIOURing::Wait(int64_t timeout_nano_time)
+{
+    if (timeout_nano_time == 0)
+    {
+        return Enter(0, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+    if (__atomic_load_n(p_cq_tail_, __ATOMIC_ACQUIRE) != *p_cq_head_)
+    {
+        return Submit();
+    }
+    if (timeout_nano_time < 0)
+    {
+        return Enter(1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+    __kernel_timespec ts;
+    ts.tv_sec = timeout_nano_time / 1000000000;
+    ts.tv_nsec = timeout_nano_time % 1000000000;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    return Enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+unsigned MIOURing::PeekCQEs(io_uring_cqe *p_cqes, unsigned count)
+{
+    unsigned head = *p_cq_head_;
+    unsigned tail = __atomic_load_n(p_cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned n = 0;
+    while (head != tail && n < count)
+    {
+        p_cqes[n++] = p_cqes_[head & cq_mask_];
+        ++head;
+    }
+    __atomic_store_n(p_cq_head_, head, __ATOMIC_RELEASE);
+    return n;
+}
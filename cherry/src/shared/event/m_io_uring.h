@@ -0,0 +1,51 @@
+#ifndef _M_IO_URING_H_
+#define _M_IO_URING_H_
+
+#include <util/m_errno.h>
+#include <util/m_type_define.h>
+#include <linux/io_uring.h>
+
+class MIOURing
+{
+public:
+    MIOURing();
+    ~MIOURing();
+    MIOURing(const MIOURing &) = delete;
+    MIOURing& operator=(const MIOURing &) = delete;
+public:
+    MError Init(unsigned entries);
+    void Clear();
+    bool IsInited() const;
+
+    MError PollAdd(int fd, unsigned events, uint64_t user_data, bool multishot);
+    MError PollRemove(uint64_t target_user_data);
+    MError Submit();
+    MError Wait(int64_t timeout_nano_time);
+    unsigned PeekCQEs(io_uring_cqe *p_cqes, unsigned count);
+private:
+    io_uring_sqe* GetSQE();
+    //multishot POLL_ADD needs 5.13, 5.11 and 5.12 fail it with EINVAL
+    bool ProbeMultishotPoll();
+    MError Enter(unsigned min_complete, unsigned flags, const void *p_arg, size_t arg_size);
+private:
+    int ring_fd_;
+    void *p_sq_ring_;
+    size_t sq_ring_size_;
+    void *p_cq_ring_;
+    size_t cq_ring_size_;
+    io_uring_sqe *p_sqes_;
+    size_t sqes_size_;
+    unsigned *p_sq_head_;
+    unsigned *p_sq_tail_;
+    unsigned *p_sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_tail_;
+    unsigned sq_pending_;
+    unsigned *p_cq_head_;
+    unsigned *p_cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe *p_cqes_;
+};
+
+#endif
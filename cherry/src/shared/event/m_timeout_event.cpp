@@ -1,8 +1,11 @@
 #include <event/m_timeout_event.h>
+#include <util/m_time.h>
 
 MTimeoutEvent::MTimeoutEvent()
     :p_event_loop_(nullptr)
     ,timeout_(0)
+    ,slack_(0)
+    ,nano_timeout_(0)
     ,repeated_(0)
 {
 }
@@ -32,7 +35,7 @@ void MTimeoutEvent::Clear()
     this->MTimerEventBase::Clear();
 }
 
-MError MTimeoutEvent::EnableEvent(const std::function<void ()> &cb, int timeout, int repeated = 0)
+MError MTimeoutEvent::EnableEvent(MInlineFunction<void ()> cb, int timeout, int repeated, int slack)
 {
     if (!cb || timeout <= 0)
     {
@@ -43,10 +46,29 @@ MError MTimeoutEvent::EnableEvent(const std::function<void ()> &cb, int timeout,
     {
         return err;
     }
-    cb_ = cb;
+    cb_ = std::move(cb);
     timeout_ = timeout;
+    slack_ = slack;
     repeated_ = repeated;
-    err = this->MTimerEventBase::EnableEvent(p_event_loop_->GetTime() + timeout_);
+    err = this->MTimerEventBase::EnableEvent(p_event_loop_->GetTime() + timeout_, slack_);
+    return err;
+}
+
+MError MTimeoutEvent::EnableNanoEvent(MInlineFunction<void ()> cb, int64_t nano_timeout, int repeated)
+{
+    if (!cb || nano_timeout <= 0)
+    {
+        return MError::Invalid;
+    }
+    MError err = DisableEvent();
+    if (err != MError::No)
+    {
+        return err;
+    }
+    cb_ = std::move(cb);
+    nano_timeout_ = nano_timeout;
+    repeated_ = repeated;
+    err = this->MTimerEventBase::EnableNanoEvent(MTime::GetMonotonicNanoTime() + nano_timeout_);
     return err;
 }
 
@@ -64,6 +86,19 @@ void MTimeoutEvent::_OnCallback()
         {
             --repeated_;
         }
-        this->MTimerEventBase::EnableEvent(p_event_loop_->GetTime() + timeout_);
+        if (IsHighRes())
+        {
+            int64_t next_time = GetStartTime() + nano_timeout_;
+            int64_t now_time = MTime::GetMonotonicNanoTime();
+            if (next_time < now_time)
+            {
+                next_time = now_time + nano_timeout_ - (now_time - next_time) % nano_timeout_;
+            }
+            this->MTimerEventBase::EnableNanoEvent(next_time);
+        }
+        else
+        {
+            this->MTimerEventBase::EnableEvent(p_event_loop_->GetTime() + timeout_, slack_);
+        }
     }
 }
@@ -3,7 +3,8 @@
 
 #include <util/m_errno.h>
 #include <event/m_event_loop.h>
-#include <functional>
+#include <util/m_type_define.h>
+#include <util/m_inline_function.h>
 
 class MTimeoutEvent
     :public MTimerEventBase
@@ -16,14 +17,17 @@ public:
 public:
     MError Init(MEventLoop *p_event_loop);
     void Clear();
-    MError EnableEvent(const std::function<void ()> &cb, int timeout, int repeated = 0);
+    MError EnableEvent(MInlineFunction<void ()> cb, int timeout, int repeated = 0, int slack = 0);
+    MError EnableNanoEvent(MInlineFunction<void ()> cb, int64_t nano_timeout, int repeated = 0);
     MError DisableEvent();
 private:
     virtual void _OnCallback() override;
 private:
     MEventLoop *p_event_loop_;
-    std::function<void ()> cb_;
+    MInlineFunction<void ()> cb_;
     int timeout_;
+    int slack_;
+    int64_t nano_timeout_;
     int repeated_;
 };
 
@@ -0,0 +1,134 @@
+#include <event/m_timer_heap.h>
+#include <event/m_event_base.h>
+
+MTimerHeap::MTimerHeap()
+{
+}
+
+MTimerHeap::~MTimerHeap()
+{
+    Clear();
+}
+
+void MTimerHeap::Clear()
+{
+    for (auto &p_event : events_)
+    {
+        p_event->heap_index_ = static_cast<size_t>(-1);
+        p_event->SetActived(false);
+    }
+    events_.clear();
+}
+
+bool MTimerHeap::Empty() const
+{
+    return events_.empty();
+}
+
+size_t MTimerHeap::GetCount() const
+{
+    return events_.size();
+}
+
+void MTimerHeap::Add(MTimerEventBase *p_event)
+{
+    p_event->heap_index_ = events_.size();
+    events_.push_back(p_event);
+    SiftUp(p_event->heap_index_);
+}
+
+void MTimerHeap::Del(MTimerEventBase *p_event)
+{
+    size_t index = p_event->heap_index_;
+    if (index >= events_.size() || events_[index] != p_event)
+    {
+        return;
+    }
+    size_t last = events_.size() - 1;
+    if (index != last)
+    {
+        Swap(index, last);
+    }
+    events_.pop_back();
+    p_event->heap_index_ = static_cast<size_t>(-1);
+    if (index != last)
+    {
+        SiftUp(index);
+        SiftDown(index);
+    }
+}
+
+bool MTimerHeap::GetNextTime(int64_t &next_time) const
+{
+    if (events_.empty())
+    {
+        return false;
+    }
+    next_time = events_[0]->start_time_;
+    return true;
+}
+
+size_t MTimerHeap::Expire(int64_t now_time)
+{
+    size_t expired = 0;
+    while (!events_.empty() && events_[0]->start_time_ <= now_time)
+    {
+        MTimerEventBase *p_event = events_[0];
+        Del(p_event);
+        p_event->SetActived(false);
+        p_event->OnCallback();
+        ++expired;
+    }
+    return expired;
+}
+
+bool MTimerHeap::Less(size_t lhs, size_t rhs) const
+{
+    return events_[lhs]->start_time_ < events_[rhs]->start_time_;
+}
+
+void MTimerHeap::Swap(size_t lhs, size_t rhs)
+{
+    MTimerEventBase *p_tmp = events_[lhs];
+    events_[lhs] = events_[rhs];
+    events_[rhs] = p_tmp;
+    events_[lhs]->heap_index_ = lhs;
+    events_[rhs]->heap_index_ = rhs;
+}
+
+void MTimerHeap::SiftUp(size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (!Less(index, parent))
+        {
+            break;
+        }
+        Swap(index, parent);
+        index = parent;
+    }
+}
+
+void MTimerHeap::SiftDown(size_t index)
+{
+    size_t count = events_.size();
+    while (true)
+    {
+        size_t child = index * 2 + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && Less(child + 1, child))
+        {
+            ++child;
+        }
+        if (!Less(child, index))
+        {
+            break;
+        }
+        Swap(index, child);
+        index = child;
+    }
+}
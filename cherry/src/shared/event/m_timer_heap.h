@@ -0,0 +1,35 @@
+#ifndef _M_TIMER_HEAP_H_
+#define _M_TIMER_HEAP_H_
+
+#include <util/m_type_define.h>
+#include <vector>
+#include <cstddef>
+
+class MTimerEventBase;
+
+class MTimerHeap
+{
+public:
+    MTimerHeap();
+    ~MTimerHeap();
+    MTimerHeap(const MTimerHeap &) = delete;
+    MTimerHeap& operator=(const MTimerHeap &) = delete;
+public:
+    void Clear();
+    bool Empty() const;
+    size_t GetCount() const;
+
+    void Add(MTimerEventBase *p_event);
+    void Del(MTimerEventBase *p_event);
+    bool GetNextTime(int64_t &next_time) const;
+    size_t Expire(int64_t now_time);
+private:
+    bool Less(size_t lhs, size_t rhs) const;
+    void Swap(size_t lhs, size_t rhs);
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+private:
+    std::vector<MTimerEventBase*> events_;
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include <event/m_timer_wheel.h>
+#include <event/m_event_base.h>
+#include <cstring>
+#include <algorithm>
+
+MTimerWheel::MTimerWheel()
+    :cur_tick_(0)
+    ,count_(0)
+    ,saved_wakeup_count_(0)
+    ,last_expire_tick_(-1)
+    ,min_start_tick_(0)
+{
+    memset(root_, 0, sizeof(root_));
+    memset(levels_, 0, sizeof(levels_));
+    memset(root_bitmap_, 0, sizeof(root_bitmap_));
+}
+
+MTimerWheel::~MTimerWheel()
+{
+    Clear();
+}
+
+void MTimerWheel::Init(int64_t cur_tick)
+{
+    Clear();
+    cur_tick_ = cur_tick;
+    last_expire_tick_ = cur_tick - 1;
+}
+
+void MTimerWheel::Clear()
+{
+    for (int i = 0; i < MTIMER_WHEEL_ROOT_SIZE; ++i)
+    {
+        while (root_[i])
+        {
+            MTimerEventBase *p_event = root_[i];
+            Del(p_event);
+            p_event->SetActived(false);
+        }
+    }
+    for (int level = 0; level < MTIMER_WHEEL_LEVEL_COUNT; ++level)
+    {
+        for (int i = 0; i < MTIMER_WHEEL_LEVEL_SIZE; ++i)
+        {
+            while (levels_[level][i])
+            {
+                MTimerEventBase *p_event = levels_[level][i];
+                Del(p_event);
+                p_event->SetActived(false);
+            }
+        }
+    }
+    count_ = 0;
+}
+
+bool MTimerWheel::Empty() const
+{
+    return count_ == 0;
+}
+
+size_t MTimerWheel::GetCount() const
+{
+    return count_;
+}
+
+int64_t MTimerWheel::GetCurTick() const
+{
+    return cur_tick_;
+}
+
+uint64_t MTimerWheel::GetSavedWakeupCount() const
+{
+    return saved_wakeup_count_;
+}
+
+MTimerEventBase** MTimerWheel::GetSlot(int64_t expire_tick)
+{
+    int64_t idx = expire_tick - cur_tick_;
+    if (idx < 0)
+    {
+        idx = 0;
+        expire_tick = cur_tick_;
+    }
+    if (idx < MTIMER_WHEEL_ROOT_SIZE)
+    {
+        int slot = static_cast<int>(expire_tick & MTIMER_WHEEL_ROOT_MASK);
+        root_bitmap_[slot >> 6] |= (static_cast<uint64_t>(1) << (slot & 63));
+        return &root_[slot];
+    }
+    int shift = MTIMER_WHEEL_ROOT_BITS;
+    for (int level = 0; level < MTIMER_WHEEL_LEVEL_COUNT - 1; ++level)
+    {
+        if (idx < (static_cast<int64_t>(1) << (shift + MTIMER_WHEEL_LEVEL_BITS)))
+        {
+            return &levels_[level][(expire_tick >> shift) & MTIMER_WHEEL_LEVEL_MASK];
+        }
+        shift += MTIMER_WHEEL_LEVEL_BITS;
+    }
+    int64_t max_idx = (static_cast<int64_t>(1) << (shift + MTIMER_WHEEL_LEVEL_BITS)) - 1;
+    if (idx > max_idx)
+    {
+        expire_tick = cur_tick_ + max_idx;
+    }
+    return &levels_[MTIMER_WHEEL_LEVEL_COUNT - 1][(expire_tick >> shift) & MTIMER_WHEEL_LEVEL_MASK];
+}
+
+void MTimerWheel::Add(MTimerEventBase *p_event)
+{
+    MTimerEventBase **pp_slot = GetSlot(p_event->start_time_);
+    p_event->p_next_ = *pp_slot;
+    if (p_event->p_next_)
+    {
+        p_event->p_next_->pp_prev_ = &p_event->p_next_;
+    }
+    p_event->pp_prev_ = pp_slot;
+    *pp_slot = p_event;
+    ++count_;
+}
+
+void MTimerWheel::Del(MTimerEventBase *p_event)
+{
+    MTimerEventBase **pp_prev = p_event->pp_prev_;
+    if (!pp_prev)
+    {
+        return;
+    }
+    *pp_prev = p_event->p_next_;
+    if (p_event->p_next_)
+    {
+        p_event->p_next_->pp_prev_ = pp_prev;
+    }
+    p_event->p_next_ = nullptr;
+    p_event->pp_prev_ = nullptr;
+    --count_;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(pp_prev);
+    if (!*pp_prev
+        && addr >= reinterpret_cast<uintptr_t>(&root_[0])
+        && addr < reinterpret_cast<uintptr_t>(&root_[MTIMER_WHEEL_ROOT_SIZE]))
+    {
+        int slot = static_cast<int>(pp_prev - &root_[0]);
+        root_bitmap_[slot >> 6] &= ~(static_cast<uint64_t>(1) << (slot & 63));
+    }
+}
+
+void MTimerWheel::Cascade(int level)
+{
+    int shift = MTIMER_WHEEL_ROOT_BITS + level * MTIMER_WHEEL_LEVEL_BITS;
+    int index = static_cast<int>((cur_tick_ >> shift) & MTIMER_WHEEL_LEVEL_MASK);
+    MTimerEventBase *p_head = levels_[level][index];
+    levels_[level][index] = nullptr;
+    while (p_head)
+    {
+        MTimerEventBase *p_event = p_head;
+        p_head = p_event->p_next_;
+        --count_;
+        Add(p_event);
+    }
+    if (index == 0 && level + 1 < MTIMER_WHEEL_LEVEL_COUNT)
+    {
+        Cascade(level + 1);
+    }
+}
+
+void MTimerWheel::CollectExpectTick(MTimerEventBase *p_head)
+{
+    for (MTimerEventBase *p_event = p_head; p_event; p_event = p_event->p_next_)
+    {
+        expect_ticks_.push_back(p_event->expect_time_);
+        min_start_tick_ = std::min(min_start_tick_, p_event->start_time_);
+    }
+}
+
+void MTimerWheel::CountSavedWakeup(int64_t now_tick)
+{
+    //one wakeup fired every collected slot, a strict loop as late as this one would still share a wakeup
+    //between deadlines within that lateness, and deadlines up to the last expire fall on iterations it makes anyway
+    std::sort(expect_ticks_.begin(), expect_ticks_.end());
+    int64_t lateness = now_tick - min_start_tick_;
+    int64_t window_end = last_expire_tick_;
+    uint64_t strict_wakeup_count = 0;
+    for (size_t i = 0; i < expect_ticks_.size(); ++i)
+    {
+        if (expect_ticks_[i] > window_end)
+        {
+            ++strict_wakeup_count;
+            window_end = expect_ticks_[i] + lateness;
+        }
+    }
+    if (strict_wakeup_count > 1)
+    {
+        saved_wakeup_count_ += strict_wakeup_count - 1;
+    }
+}
+
+int MTimerWheel::FindRootSlot(int from) const
+{
+    int word = from >> 6;
+    uint64_t bits = root_bitmap_[word] & (~static_cast<uint64_t>(0) << (from & 63));
+    while (true)
+    {
+        if (bits)
+        {
+            return (word << 6) + __builtin_ctzll(bits);
+        }
+        if (++word >= MTIMER_WHEEL_ROOT_SIZE / 64)
+        {
+            return -1;
+        }
+        bits = root_bitmap_[word];
+    }
+}
+
+bool MTimerWheel::GetNextTick(int64_t &next_tick) const
+{
+    if (count_ == 0)
+    {
+        return false;
+    }
+    int64_t base = cur_tick_ & ~static_cast<int64_t>(MTIMER_WHEEL_ROOT_MASK);
+    int slot = FindRootSlot(static_cast<int>(cur_tick_ & MTIMER_WHEEL_ROOT_MASK));
+    next_tick = slot < 0 ? base + MTIMER_WHEEL_ROOT_SIZE : base + slot;
+    return true;
+}
+
+size_t MTimerWheel::Expire(int64_t now_tick)
+{
+    size_t expired = 0;
+    expect_ticks_.clear();
+    min_start_tick_ = now_tick;
+    while (cur_tick_ <= now_tick)
+    {
+        if (count_ == 0)
+        {
+            cur_tick_ = now_tick + 1;
+            break;
+        }
+        int64_t base = cur_tick_ & ~static_cast<int64_t>(MTIMER_WHEEL_ROOT_MASK);
+        int slot = FindRootSlot(static_cast<int>(cur_tick_ & MTIMER_WHEEL_ROOT_MASK));
+        int64_t next_tick = slot < 0 ? base + MTIMER_WHEEL_ROOT_SIZE : base + slot;
+        if (next_tick > now_tick)
+        {
+            cur_tick_ = now_tick + 1;
+            if ((cur_tick_ & MTIMER_WHEEL_ROOT_MASK) == 0)
+            {
+                Cascade(0);
+            }
+            break;
+        }
+        if (slot < 0)
+        {
+            cur_tick_ = next_tick;
+            Cascade(0);
+            continue;
+        }
+        MTimerEventBase *p_head = root_[slot];
+        root_[slot] = nullptr;
+        root_bitmap_[slot >> 6] &= ~(static_cast<uint64_t>(1) << (slot & 63));
+        p_head->pp_prev_ = &p_head;
+        CollectExpectTick(p_head);
+        cur_tick_ = next_tick + 1;
+        if ((cur_tick_ & MTIMER_WHEEL_ROOT_MASK) == 0)
+        {
+            Cascade(0);
+        }
+        while (p_head)
+        {
+            MTimerEventBase *p_event = p_head;
+            Del(p_event);
+            p_event->SetActived(false);
+            p_event->OnCallback();
+            ++expired;
+        }
+    }
+    if (expired > 0)
+    {
+        CountSavedWakeup(now_tick);
+    }
+    last_expire_tick_ = now_tick;
+    return expired;
+}
@@ -0,0 +1,56 @@
+#ifndef _M_TIMER_WHEEL_H_
+#define _M_TIMER_WHEEL_H_
+
+#include <util/m_errno.h>
+#include <util/m_type_define.h>
+#include <cstddef>
+#include <vector>
+
+class MTimerEventBase;
+
+#define MTIMER_WHEEL_ROOT_BITS   8
+#define MTIMER_WHEEL_LEVEL_BITS  6
+#define MTIMER_WHEEL_ROOT_SIZE   (1 << MTIMER_WHEEL_ROOT_BITS)
+#define MTIMER_WHEEL_LEVEL_SIZE  (1 << MTIMER_WHEEL_LEVEL_BITS)
+#define MTIMER_WHEEL_ROOT_MASK   (MTIMER_WHEEL_ROOT_SIZE - 1)
+#define MTIMER_WHEEL_LEVEL_MASK  (MTIMER_WHEEL_LEVEL_SIZE - 1)
+#define MTIMER_WHEEL_LEVEL_COUNT 4
+
+class MTimerWheel
+{
+public:
+    MTimerWheel();
+    ~MTimerWheel();
+    MTimerWheel(const MTimerWheel &) = delete;
+    MTimerWheel& operator=(const MTimerWheel &) = delete;
+public:
+    void Init(int64_t cur_tick);
+    void Clear();
+    bool Empty() const;
+    size_t GetCount() const;
+    int64_t GetCurTick() const;
+    uint64_t GetSavedWakeupCount() const;
+
+    void Add(MTimerEventBase *p_event);
+    void Del(MTimerEventBase *p_event);
+    bool GetNextTick(int64_t &next_tick) const;
+    size_t Expire(int64_t now_tick);
+private:
+    MTimerEventBase** GetSlot(int64_t expire_tick);
+    void Cascade(int level);
+    int FindRootSlot(int from) const;
+    void CollectExpectTick(MTimerEventBase *p_head);
+    void CountSavedWakeup(int64_t now_tick);
+private:
+    int64_t cur_tick_;
+    size_t count_;
+    MTimerEventBase *root_[MTIMER_WHEEL_ROOT_SIZE];
+    MTimerEventBase *levels_[MTIMER_WHEEL_LEVEL_COUNT][MTIMER_WHEEL_LEVEL_SIZE];
+    uint64_t root_bitmap_[MTIMER_WHEEL_ROOT_SIZE / 64];
+    uint64_t saved_wakeup_count_;
+    int64_t last_expire_tick_;
+    int64_t min_start_tick_;
+    std::vector<int64_t> expect_ticks_;
+};
+
+#endif
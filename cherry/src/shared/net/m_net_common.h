@@ -10,4 +10,6 @@
 #define M_NET_EVENT_LEVEL 0
 #define M_NET_EVENT_EDGE EPOLLET
 
+#define M_NET_CACHE_LINE_SIZE 64
+
 #endif
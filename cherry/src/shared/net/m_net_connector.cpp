@@ -2,6 +2,7 @@
 #include <net/m_socket.h>
 #include <net/m_net_event_loop.h>
 #include <util/m_logger.h>
+#include <util/m_object_pool.h>
 
 MNetConnector::MNetConnector(MSocket *p_sock, MNetEventLoop *p_event_loop
         , const std::function<void ()> &connect_cb, const std::function<void ()> &read_cb, const std::function<void ()> &write_complete_cb, const std::function<void (MError)> &error_cb
@@ -16,17 +17,47 @@ MNetConnector::MNetConnector(MSocket *p_sock, MNetEventLoop *p_event_loop
     ,read_buffer_(read_len)
     ,write_buffer_(write_len)
     ,write_ready_(true)
+    ,read_idle_time_(0)
+    ,write_idle_time_(0)
+    ,heartbeat_time_(0)
+    ,heartbeat_cb_(nullptr)
+    ,last_read_time_(0)
+    ,last_write_time_(0)
+    ,timeout_deadline_(0)
+    ,p_timeout_next_(nullptr)
+    ,pp_timeout_prev_(nullptr)
+    ,high_water_mark_(0)
+    ,low_water_mark_(0)
+    ,high_water_time_(0)
+    ,high_water_cb_(nullptr)
+    ,low_water_cb_(nullptr)
+    ,above_high_water_(false)
+    ,high_water_since_(0)
+    ,cork_(false)
+    ,p_flush_next_(nullptr)
+    ,pp_flush_prev_(nullptr)
 {
 }
 
 MNetConnector::~MNetConnector()
 {
+    DetachFromLoop();
     if (need_free_sock_ && p_sock_)
     {
         delete p_sock_;
     }
 }
 
+void* MNetConnector::operator new(size_t size)
+{
+    return MObjectPool<MNetConnector>::Alloc(size);
+}
+
+void MNetConnector::operator delete(void *p, size_t size)
+{
+    MObjectPool<MNetConnector>::Free(p, size);
+}
+
 void MNetConnector::SetSocket(MSocket *p_sock)
 {
     p_sock_ = p_sock;
@@ -45,7 +76,9 @@ MNetEvent& MNetConnector::GetEvent()
 
 void MNetConnector::SetEventLoop(MNetEventLoop *p_event_loop)
 {
+    DetachFromLoop();
     event_.SetEventLoop(p_event_loop);
+    AttachToLoop();
 }
 
 MNetEventLoop* MNetConnector::GetEventLoop()
@@ -132,6 +165,15 @@ MError MNetConnector::Connect(const std::string &ip, unsigned port)
 }
 
 MError MNetConnector::ReadBuf(void *p_buf, size_t len)
+{
+    if (!read_buffer_.Read(p_buf, len))
+    {
+        return MError::Underflow;
+    }
+    return MError::No;
+}
+
+MError MNetConnector::PeekReadBuf(void *p_buf, size_t len) const
 {
     if (!read_buffer_.Peek(p_buf, len))
     {
@@ -140,6 +182,20 @@ MError MNetConnector::ReadBuf(void *p_buf, size_t len)
     return MError::No;
 }
 
+const char* MNetConnector::GetReadBufView(size_t offset, size_t len) const
+{
+    return read_buffer_.GetContiguous(offset, len);
+}
+
+MError MNetConnector::SkipReadBuf(size_t len)
+{
+    if (!read_buffer_.Drain(len))
+    {
+        return MError::Underflow;
+    }
+    return MError::No;
+}
+
 size_t MNetConnector::GetReadBufLen() const
 {
     return read_buffer_.GetLen();
@@ -147,42 +203,152 @@ size_t MNetConnector::GetReadBufLen() const
 
 MError MNetConnector::WriteBuf(const char *p_buf, size_t len)
 {
-    if (write_ready_)
+    if (!write_ready_ || cork_)
     {
-        std::pair<int, MError> ret = p_sock_->Send(p_buf, len);
-        if (ret.second == MError::No)
+        if (!write_buffer_.Append(p_buf, len))
+        {
+            return MError::Overflow;
+        }
+        GetEventLoop()->AddQueuedBytes(static_cast<int64_t>(len));
+        if (write_ready_)
+        {
+            GetEventLoop()->AddFlush(this);
+        }
+        CheckWatermark();
+        return MError::No;
+    }
+    std::pair<int, MError> ret = p_sock_->Send(p_buf, len);
+    if (ret.second != MError::No
+        && ret.second != MError::InterruptedSysCall
+        && ret.second != MError::Again)
+    {
+        return MError::Unknown;
+    }
+    MarkWriteProgress();
+    GetEventLoop()->AddTrafficBytes(ret.first);
+    if (static_cast<size_t>(ret.first) == len)
+    {
+        if (write_complete_cb_)
+        {
+            write_complete_cb_();
+        }
+        return MError::No;
+    }
+    if (!write_buffer_.Append(p_buf + ret.first, len - ret.first))
+    {
+        return MError::Overflow;
+    }
+    GetEventLoop()->AddQueuedBytes(static_cast<int64_t>(len - ret.first));
+    write_ready_ = false;
+    ScheduleTimeout();
+    MError err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
+    CheckWatermark();
+    return err;
+}
+
+MError MNetConnector::WriteBuf(const iovec *p_iov, int count)
+{
+    size_t len = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        len += p_iov[i].iov_len;
+    }
+    if (write_buffer_.GetMaxLen() > 0 && len > write_buffer_.GetMaxLen() - write_buffer_.GetLen())
+    {
+        return MError::Overflow;
+    }
+    size_t sent = 0;
+    if (write_ready_ && !cork_)
+    {
+        std::pair<int, MError> ret = p_sock_->Writev(p_iov, count);
+        if (ret.second != MError::No
+            && ret.second != MError::InterruptedSysCall
+            && ret.second != MError::Again)
+        {
+            return MError::Unknown;
+        }
+        MarkWriteProgress();
+        sent = static_cast<size_t>(ret.first);
+        GetEventLoop()->AddTrafficBytes(sent);
+        if (sent == len)
         {
-            if (static_cast<size_t>(ret.first) < len)
-            {
-                if (!write_buffer_.Append(p_buf + ret.first, len - ret.first))
-                {
-                    return MError::Overflow;
-                }
-                write_ready_ = false;
-                return event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
-            }
             if (write_complete_cb_)
             {
                 write_complete_cb_();
             }
             return MError::No;
         }
-        else if (ret.second == MError::InterruptedSysCall
-            || ret.second == MError::Again)
+    }
+    size_t queued = len - sent;
+    for (int i = 0; i < count; ++i)
+    {
+        if (sent >= p_iov[i].iov_len)
         {
-            write_ready_ = false;
-            return event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
+            sent -= p_iov[i].iov_len;
+            continue;
         }
-        else
+        write_buffer_.Append(static_cast<const char*>(p_iov[i].iov_base) + sent, p_iov[i].iov_len - sent);
+        sent = 0;
+    }
+    GetEventLoop()->AddQueuedBytes(static_cast<int64_t>(queued));
+    MError err = MError::No;
+    if (write_ready_ && cork_)
+    {
+        GetEventLoop()->AddFlush(this);
+    }
+    else if (write_ready_)
+    {
+        write_ready_ = false;
+        ScheduleTimeout();
+        err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
+    }
+    CheckWatermark();
+    return err;
+}
+
+MError MNetConnector::WriteBuf(const MSharedBuffer &buffer)
+{
+    if (!write_ready_ || cork_)
+    {
+        if (!write_buffer_.AppendShared(buffer))
         {
-            return MError::Unknown;
+            return MError::Overflow;
         }
+        GetEventLoop()->AddQueuedBytes(static_cast<int64_t>(buffer.GetLen()));
+        if (write_ready_)
+        {
+            GetEventLoop()->AddFlush(this);
+        }
+        CheckWatermark();
+        return MError::No;
     }
-    else
+    std::pair<int, MError> ret = p_sock_->Send(buffer.GetData(), buffer.GetLen());
+    if (ret.second != MError::No
+        && ret.second != MError::InterruptedSysCall
+        && ret.second != MError::Again)
+    {
+        return MError::Unknown;
+    }
+    MarkWriteProgress();
+    GetEventLoop()->AddTrafficBytes(ret.first);
+    if (static_cast<size_t>(ret.first) == buffer.GetLen())
+    {
+        if (write_complete_cb_)
+        {
+            write_complete_cb_();
+        }
+        return MError::No;
+    }
+    if (!write_buffer_.AppendShared(buffer, ret.first))
     {
-        return write_buffer_.Append(p_buf, len) ? MError::No : MError::Overflow;
+        return MError::Overflow;
     }
-    return MError::No;
+    GetEventLoop()->AddQueuedBytes(static_cast<int64_t>(buffer.GetLen() - ret.first));
+    write_ready_ = false;
+    ScheduleTimeout();
+    MError err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
+    CheckWatermark();
+    return err;
 }
 
 size_t MNetConnector::GetWriteBufLen() const
@@ -192,12 +358,12 @@ size_t MNetConnector::GetWriteBufLen() const
 
 void MNetConnector::OnReadCallback()
 {
-    std::pair<char*, size_t> buf;
+    iovec iov[MNET_CONNECTOR_READ_IOV];
     std::pair<int, MError> ret;
     while (true)
     {
-        buf = read_buffer_.GetNextCapacity();
-        if (!buf.first || buf.second == 0)
+        int count = read_buffer_.GetCapacityIov(iov, MNET_CONNECTOR_READ_IOV);
+        if (count == 0)
         {
             if (read_cb_)
             {
@@ -205,7 +371,13 @@ void MNetConnector::OnReadCallback()
             }
             return;
         }
-        ret = p_sock_->Recv(buf.first, static_cast<int>(buf.second));
+        size_t capacity = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            capacity += iov[i].iov_len;
+        }
+        ret = p_sock_->Readv(iov, count);
+        read_buffer_.AddEndLen(ret.second == MError::No ? ret.first : 0);
         if (ret.second == MError::No)
         {
             if (ret.first == 0)
@@ -214,21 +386,15 @@ void MNetConnector::OnReadCallback()
                 OnErrorCallback(MError::Disconnect);
                 return;
             }
-            else
+            last_read_time_ = GetEventLoop()->GetTime();
+            GetEventLoop()->AddTrafficBytes(ret.first);
+            if (static_cast<size_t>(ret.first) < capacity)
             {
-                if (!read_buffer_.AddEndLen(ret.first))
-                {
-                    OnErrorCallback(MError::Unknown);
-                    return;
-                }
-                if (static_cast<size_t>(ret.first) < buf.second)
+                if (read_cb_)
                 {
-                    if (read_cb_)
-                    {
-                        read_cb_();
-                    }
-                    return;
+                    read_cb_();
                 }
+                return;
             }
         }
         else if (ret.second == MError::InterruptedSysCall
@@ -250,56 +416,353 @@ void MNetConnector::OnReadCallback()
 
 void MNetConnector::OnWriteCallback()
 {
-    std::pair<const char*, size_t> buf;
+    MError err = WriteQueued();
+    if (err == MError::Again)
+    {
+        CheckWatermark();
+        return;
+    }
+    if (err != MError::No)
+    {
+        OnErrorCallback(err);
+        return;
+    }
+    err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_LEVEL);
+    if (err != MError::No)
+    {
+        OnErrorCallback(err);
+        return;
+    }
+    write_ready_ = true;
+    ScheduleTimeout();
+    CheckWatermark();
+    if (write_complete_cb_)
+    {
+        write_complete_cb_();
+    }
+}
+
+void MNetConnector::OnErrorCallback(MError err)
+{
+    if (error_cb_)
+    {
+        error_cb_(err);
+    }
+}
+
+MError MNetConnector::EnableIdleTimeout(int64_t read_idle_time, int64_t write_idle_time
+    , int64_t heartbeat_time, const std::function<void ()> &heartbeat_cb)
+{
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (!p_event_loop)
+    {
+        MLOG(MGetLibLogger(), MERR, "event loop is null");
+        return MError::Invalid;
+    }
+    if (read_idle_time < 0 || write_idle_time < 0 || heartbeat_time < 0
+        || (heartbeat_time > 0 && !heartbeat_cb))
+    {
+        MLOG(MGetLibLogger(), MERR, "invalid idle timeout");
+        return MError::Invalid;
+    }
+    DisableIdleTimeout();
+    read_idle_time_ = read_idle_time;
+    write_idle_time_ = write_idle_time;
+    heartbeat_time_ = heartbeat_time;
+    heartbeat_cb_ = heartbeat_cb;
+    last_read_time_ = p_event_loop->GetTime();
+    last_write_time_ = last_read_time_;
+    ScheduleTimeout();
+    return MError::No;
+}
+
+//a pending wheel entry is left to expire lazily, it is not renewed once nothing is armed
+void MNetConnector::DisableIdleTimeout()
+{
+    read_idle_time_ = 0;
+    write_idle_time_ = 0;
+    heartbeat_time_ = 0;
+    heartbeat_cb_ = nullptr;
+}
+
+int64_t MNetConnector::GetLastReadTime() const
+{
+    return last_read_time_;
+}
+
+int64_t MNetConnector::GetLastWriteTime() const
+{
+    return last_write_time_;
+}
+
+int64_t MNetConnector::GetNextDeadline() const
+{
+    int64_t deadline = -1;
+    if (read_idle_time_ > 0)
+    {
+        deadline = last_read_time_ + read_idle_time_;
+    }
+    int64_t write_deadline = -1;
+    if (!write_ready_ && write_idle_time_ > 0)
+    {
+        write_deadline = last_write_time_ + write_idle_time_;
+    }
+    else if (write_ready_ && heartbeat_time_ > 0)
+    {
+        write_deadline = last_write_time_ + heartbeat_time_;
+    }
+    if (write_deadline >= 0 && (deadline < 0 || write_deadline < deadline))
+    {
+        deadline = write_deadline;
+    }
+    if (above_high_water_ && high_water_time_ > 0)
+    {
+        int64_t high_water_deadline = high_water_since_ + high_water_time_;
+        if (deadline < 0 || high_water_deadline < deadline)
+        {
+            deadline = high_water_deadline;
+        }
+    }
+    return deadline;
+}
+
+//touches only move deadlines later, so the wheel entry is renewed lazily when it fires
+void MNetConnector::ScheduleTimeout()
+{
+    int64_t deadline = GetNextDeadline();
+    if (deadline < 0)
+    {
+        return;
+    }
+    MNetTimeoutWheel &wheel = GetEventLoop()->GetTimeoutWheel();
+    if (pp_timeout_prev_)
+    {
+        if (deadline >= timeout_deadline_)
+        {
+            return;
+        }
+        wheel.Del(this);
+    }
+    timeout_deadline_ = deadline;
+    wheel.Add(this);
+}
+
+void MNetConnector::MarkWriteProgress()
+{
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (p_event_loop)
+    {
+        last_write_time_ = p_event_loop->GetTime();
+    }
+}
+
+void MNetConnector::OnTimeoutCallback(int64_t now)
+{
+    if (read_idle_time_ > 0 && now - last_read_time_ >= read_idle_time_)
+    {
+        event_.DisableEvents();
+        OnErrorCallback(MError::Timeout);
+        return;
+    }
+    if (!write_ready_ && write_idle_time_ > 0 && now - last_write_time_ >= write_idle_time_)
+    {
+        event_.DisableEvents();
+        OnErrorCallback(MError::Timeout);
+        return;
+    }
+    if (above_high_water_ && high_water_time_ > 0 && now - high_water_since_ >= high_water_time_)
+    {
+        event_.DisableEvents();
+        OnErrorCallback(MError::Overflow);
+        return;
+    }
+    if (write_ready_ && heartbeat_time_ > 0 && now - last_write_time_ >= heartbeat_time_)
+    {
+        last_write_time_ = now;
+        ScheduleTimeout();
+        heartbeat_cb_();
+        return;
+    }
+    ScheduleTimeout();
+}
+
+void MNetConnector::SetWriteWatermark(size_t high_water_mark, size_t low_water_mark
+    , const std::function<void ()> &high_water_cb, const std::function<void ()> &low_water_cb
+    , int64_t high_water_time)
+{
+    high_water_mark_ = high_water_mark;
+    low_water_mark_ = low_water_mark < high_water_mark ? low_water_mark : high_water_mark;
+    high_water_cb_ = high_water_cb;
+    low_water_cb_ = low_water_cb;
+    high_water_time_ = high_water_time;
+    if (GetEventLoop())
+    {
+        ScheduleTimeout();
+        CheckWatermark();
+    }
+}
+
+bool MNetConnector::IsAboveHighWater() const
+{
+    return above_high_water_;
+}
+
+void MNetConnector::CheckWatermark()
+{
+    size_t len = write_buffer_.GetLen();
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (!above_high_water_)
+    {
+        if (high_water_mark_ == 0 || len < high_water_mark_)
+        {
+            return;
+        }
+        above_high_water_ = true;
+        high_water_since_ = p_event_loop->GetTime();
+        p_event_loop->AddHighWaterCount(1);
+        ScheduleTimeout();
+        if (high_water_cb_)
+        {
+            high_water_cb_();
+        }
+    }
+    else if (high_water_mark_ == 0 || len <= low_water_mark_)
+    {
+        above_high_water_ = false;
+        p_event_loop->AddHighWaterCount(-1);
+        if (low_water_cb_)
+        {
+            low_water_cb_();
+        }
+    }
+}
+
+void MNetConnector::AttachToLoop()
+{
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (!p_event_loop)
+    {
+        return;
+    }
+    p_event_loop->AddQueuedBytes(static_cast<int64_t>(write_buffer_.GetLen()));
+    if (above_high_water_)
+    {
+        p_event_loop->AddHighWaterCount(1);
+    }
+    if (write_ready_ && !write_buffer_.Empty())
+    {
+        p_event_loop->AddFlush(this);
+    }
+    ScheduleTimeout();
+}
+
+void MNetConnector::DetachFromLoop()
+{
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (!p_event_loop)
+    {
+        return;
+    }
+    if (pp_timeout_prev_)
+    {
+        p_event_loop->GetTimeoutWheel().Del(this);
+    }
+    p_event_loop->DelFlush(this);
+    p_event_loop->AddQueuedBytes(-static_cast<int64_t>(write_buffer_.GetLen()));
+    if (above_high_water_)
+    {
+        p_event_loop->AddHighWaterCount(-1);
+    }
+}
+
+void MNetConnector::SetCork(bool cork)
+{
+    cork_ = cork;
+    if (!cork_)
+    {
+        Flush();
+    }
+}
+
+bool MNetConnector::IsCork() const
+{
+    return cork_;
+}
+
+void MNetConnector::Flush()
+{
+    MNetEventLoop *p_event_loop = GetEventLoop();
+    if (p_event_loop)
+    {
+        p_event_loop->DelFlush(this);
+    }
+    if (!write_ready_ || write_buffer_.Empty())
+    {
+        return;
+    }
+    MError err = WriteQueued();
+    if (err == MError::No)
+    {
+        CheckWatermark();
+        if (write_complete_cb_)
+        {
+            write_complete_cb_();
+        }
+        return;
+    }
+    if (err != MError::Again)
+    {
+        OnErrorCallback(err);
+        return;
+    }
+    write_ready_ = false;
+    ScheduleTimeout();
+    err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_WRITE|M_NET_EVENT_LEVEL);
+    if (err != MError::No)
+    {
+        OnErrorCallback(err);
+        return;
+    }
+    CheckWatermark();
+}
+
+//No when drained, Again when the socket is full
+MError MNetConnector::WriteQueued()
+{
+    iovec iov[MNET_CONNECTOR_WRITE_IOV];
     std::pair<int, MError> ret;
     while (true)
     {
-        buf = read_buffer_.GetNextData();
-        if (!buf.first || buf.second == 0)
+        int count = write_buffer_.GetDataIov(iov, MNET_CONNECTOR_WRITE_IOV);
+        if (count == 0)
         {
-            MError err = event_.EnableEvents(M_NET_EVENT_READ|M_NET_EVENT_LEVEL);
-            if (err != MError::No)
-            {
-                OnErrorCallback(err);
-                return;
-            }
-            write_ready_ = true;
-            if (write_complete_cb_)
-            {
-                write_complete_cb_();
-            }
-            return;
+            return MError::No;
+        }
+        size_t data_len = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            data_len += iov[i].iov_len;
         }
-        ret = p_sock_->Send(buf.first, static_cast<int>(buf.second));
+        ret = p_sock_->Writev(iov, count);
         if (ret.second == MError::No)
         {
-            if (!write_buffer_.AddStartLen(ret.first))
+            MarkWriteProgress();
+            GetEventLoop()->AddTrafficBytes(ret.first);
+            write_buffer_.Drain(ret.first);
+            GetEventLoop()->AddQueuedBytes(-static_cast<int64_t>(ret.first));
+            if (static_cast<size_t>(ret.first) < data_len)
             {
-                OnErrorCallback(MError::Unknown);
-                return;
-            }
-            if (static_cast<size_t>(ret.first) < buf.second)
-            {
-                return;
+                return MError::Again;
             }
         }
         else if (ret.second == MError::InterruptedSysCall
             || ret.second == MError::Again)
         {
-            return;
+            return MError::Again;
         }
         else
         {
-            OnErrorCallback(ret.second);
-            return;
+            return ret.second;
         }
     }
 }
-
-void MNetConnector::OnErrorCallback(MError err)
-{
-    if (error_cb_)
-    {
-        error_cb_(err);
-    }
-}
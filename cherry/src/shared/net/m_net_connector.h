@@ -2,20 +2,30 @@
 #define _M_NET_CONNECTOR_H_
 
 #include <net/m_net_event.h>
-#include <util/m_circle_buffer.h>
+#include <util/m_buffer_chain.h>
+#include <string>
 
 class MSocket;
 class MNetEventLoop;
 
+#define MNET_CONNECTOR_READ_IOV  4
+#define MNET_CONNECTOR_WRITE_IOV 64
+
 class MNetConnector
 {
+    friend class MNetTimeoutWheel;
+    friend class MNetEventLoop;
 public:
+    //read_len and write_len cap the buffered bytes, 0 means unbounded
     explicit MNetConnector(MSocket *p_sock, MNetEventLoop *p_event_loop
         , const std::function<void ()> &connect_cb, const std::function<void ()> &read_cb, const std::function<void ()> &write_complete_cb, const std::function<void (MError)> &error_cb
         , bool need_free_sock, size_t read_len, size_t write_len);
     ~MNetConnector();
     MNetConnector(const MNetConnector &) = delete;
     MNetConnector& operator=(const MNetConnector &) = delete;
+    //allocated from MObjectPool<MNetConnector>
+    static void* operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 public:
     void SetSocket(MSocket *p_sock);
     MSocket* GetSocket();
@@ -37,13 +47,52 @@ public:
 
     MError Connect(const std::string &ip, unsigned port);
     MError ReadBuf(void *p_buf, size_t len);
+    MError PeekReadBuf(void *p_buf, size_t len) const;
+    //zero copy view of [offset, offset+len) of the read buffer, nullptr if it spans blocks
+    const char* GetReadBufView(size_t offset, size_t len) const;
+    MError SkipReadBuf(size_t len);
     size_t GetReadBufLen() const;
     MError WriteBuf(const char *p_buf, size_t len);
+    MError WriteBuf(const iovec *p_iov, int count);
+    //whatever can not be sent at once is queued as a reference to buffer, not copied
+    MError WriteBuf(const MSharedBuffer &buffer);
     size_t GetWriteBufLen() const;
+
+    //milliseconds, 0 disables the check, call from the loop thread
+    //read_idle_time: nothing received
+    //write_idle_time: pending output made no progress
+    //heartbeat_time: nothing sent, heartbeat_cb is called to send a ping
+    MError EnableIdleTimeout(int64_t read_idle_time, int64_t write_idle_time
+        , int64_t heartbeat_time = 0, const std::function<void ()> &heartbeat_cb = nullptr);
+    void DisableIdleTimeout();
+    int64_t GetLastReadTime() const;
+    int64_t GetLastWriteTime() const;
+
+    //high_water_cb fires when queued output reaches high_water_mark, low_water_cb when it drains to low_water_mark
+    //high_water_time > 0 disconnects with MError::Overflow after staying above the high mark that long
+    //the callbacks must not free the connector
+    void SetWriteWatermark(size_t high_water_mark, size_t low_water_mark
+        , const std::function<void ()> &high_water_cb, const std::function<void ()> &low_water_cb
+        , int64_t high_water_time = 0);
+    bool IsAboveHighWater() const;
+
+    //corked writes are only queued, the loop flushes them with one writev after dispatching
+    void SetCork(bool cork);
+    bool IsCork() const;
+    void Flush();
 public:
     void OnReadCallback();
     void OnWriteCallback();
     void OnErrorCallback(MError err);
+private:
+    void OnTimeoutCallback(int64_t now);
+    int64_t GetNextDeadline() const;
+    void ScheduleTimeout();
+    void MarkWriteProgress();
+    void CheckWatermark();
+    MError WriteQueued();
+    void AttachToLoop();
+    void DetachFromLoop();
 private:
     MSocket *p_sock_;
     MNetEvent event_;
@@ -52,9 +101,28 @@ private:
     std::function<void ()> write_complete_cb_;
     std::function<void (MError)> error_cb_;
     bool need_free_sock_;
-    MCircleBuffer read_buffer_;
-    MCircleBuffer write_buffer_;
+    MBufferChain read_buffer_;
+    MBufferChain write_buffer_;
     bool write_ready_;
+    int64_t read_idle_time_;
+    int64_t write_idle_time_;
+    int64_t heartbeat_time_;
+    std::function<void ()> heartbeat_cb_;
+    int64_t last_read_time_;
+    int64_t last_write_time_;
+    int64_t timeout_deadline_;
+    MNetConnector *p_timeout_next_;
+    MNetConnector **pp_timeout_prev_;
+    size_t high_water_mark_;
+    size_t low_water_mark_;
+    int64_t high_water_time_;
+    std::function<void ()> high_water_cb_;
+    std::function<void ()> low_water_cb_;
+    bool above_high_water_;
+    int64_t high_water_since_;
+    bool cork_;
+    MNetConnector *p_flush_next_;
+    MNetConnector **pp_flush_prev_;
 };
 
 #endif
@@ -1,14 +1,25 @@
 #include <net/m_net_event_loop.h>
 #include <net/m_net_event.h>
+#include <net/m_net_connector.h>
 #include <fcntl.h>
 #include <util/m_logger.h>
+#include <util/m_time.h>
 
 MNetEventLoop::MNetEventLoop(size_t single_process_events)
     :epoll_fd_(-1)
     ,event_list_(single_process_events)
     ,interrupter_{-1, -1}
-    ,event_count_(0)
+    ,cur_time_(MTime::GetMonotonicTime())
+    ,heartbeat_(0)
+    ,stage_(static_cast<int>(MNetLoopStage::Poll))
+    ,busy_since_(0)
+    ,queued_bytes_(0)
+    ,high_water_count_(0)
+    ,p_flush_head_(nullptr)
 {
+    stats_.event_count.store(0, std::memory_order_relaxed);
+    stats_.recent_bytes.store(0, std::memory_order_relaxed);
+    stats_.decay_time.store(cur_time_, std::memory_order_relaxed);
 }
 
 MNetEventLoop::~MNetEventLoop()
@@ -18,7 +29,7 @@ MNetEventLoop::~MNetEventLoop()
 
 size_t MNetEventLoop::GetEventCount() const
 {
-    return event_count_;
+    return stats_.event_count.load(std::memory_order_relaxed);
 }
 
 MError MNetEventLoop::Create()
@@ -53,6 +64,8 @@ MError MNetEventLoop::Create()
         int tmp = 1;
         write(interrupter_[1], &tmp, sizeof(tmp));
     }
+    cur_time_ = MTime::GetMonotonicTime();
+    timeout_wheel_.Init(cur_time_);
     return MError::No;
 }
 
@@ -100,7 +113,7 @@ MError MNetEventLoop::AddEvent(int fd, int events, MNetEvent *p_event)
         MLOG(MGetLibLogger(), MERR, "epoll ctl failed errno:", errno);
         return MError::Unknown;
     }
-    ++event_count_;
+    stats_.event_count.fetch_add(1, std::memory_order_relaxed);
     return MError::No;
 }
 
@@ -127,17 +140,30 @@ MError MNetEventLoop::DelEvent(int fd)
         MLOG(MGetLibLogger(), MERR, "epoll ctl failed errno:", errno);
         return MError::Unknown;
     }
-    --event_count_;
+    stats_.event_count.fetch_sub(1, std::memory_order_relaxed);
     return MError::No;
 }
 
 MError MNetEventLoop::ProcessEvents()
 {
-    int max_events = epoll_wait(epoll_fd_, &event_list_[0], event_list_.size(), -1);
+    heartbeat_.fetch_add(1, std::memory_order_relaxed);
+    SetStage(MNetLoopStage::Poll);
+    int max_events = epoll_wait(epoll_fd_, &event_list_[0], event_list_.size(), timeout_wheel_.GetWaitTime(cur_time_));
+    cur_time_ = MTime::GetMonotonicTime();
+    busy_since_.store(cur_time_, std::memory_order_relaxed);
+    int64_t decay_time = stats_.decay_time.load(std::memory_order_relaxed);
+    if (cur_time_ - decay_time >= MNET_LOOP_TRAFFIC_DECAY_TIME)
+    {
+        int64_t period = (cur_time_ - decay_time) / MNET_LOOP_TRAFFIC_DECAY_TIME;
+        stats_.recent_bytes.store(period < 64 ? stats_.recent_bytes.load(std::memory_order_relaxed) >> period : 0, std::memory_order_relaxed);
+        stats_.decay_time.store(decay_time + period * MNET_LOOP_TRAFFIC_DECAY_TIME, std::memory_order_relaxed);
+    }
     if (max_events == -1)
     {
         if (errno == EINTR)
         {
+            SetStage(MNetLoopStage::Timeout);
+            timeout_wheel_.Expire(cur_time_);
             return MError::No;
         }
         MLOG(MGetLibLogger(), MERR, "epoll wait failed errno:", errno);
@@ -157,6 +183,7 @@ MError MNetEventLoop::ProcessEvents()
         int events = event_list_[i].events;
         if (events & (EPOLLERR|EPOLLHUP))
         {
+            SetStage(MNetLoopStage::Error);
             p_event->OnErrorCallback(MError::Disconnect);
             continue;
         }
@@ -164,16 +191,23 @@ MError MNetEventLoop::ProcessEvents()
         {
             if (events & EPOLLRDHUP)
             {
+                SetStage(MNetLoopStage::Error);
                 p_event->OnErrorCallback(MError::Disconnect);
                 continue;
             }
+            SetStage(MNetLoopStage::Read);
             p_event->OnReadCallback();
         }
         if (events & EPOLLOUT)
         {
+            SetStage(MNetLoopStage::Write);
             p_event->OnWriteCallback();
         }
     }
+    SetStage(MNetLoopStage::Timeout);
+    timeout_wheel_.Expire(cur_time_);
+    SetStage(MNetLoopStage::Write);
+    FlushPending();
     return MError::No;
 }
 
@@ -189,3 +223,116 @@ MError MNetEventLoop::Interrupt()
     }
     return MError::No;
 }
+
+int64_t MNetEventLoop::GetTime() const
+{
+    return cur_time_;
+}
+
+MNetTimeoutWheel& MNetEventLoop::GetTimeoutWheel()
+{
+    return timeout_wheel_;
+}
+
+uint64_t MNetEventLoop::GetHeartbeat() const
+{
+    return heartbeat_.load(std::memory_order_relaxed);
+}
+
+MNetLoopStage MNetEventLoop::GetStage() const
+{
+    return static_cast<MNetLoopStage>(stage_.load(std::memory_order_acquire));
+}
+
+int64_t MNetEventLoop::GetBusySince() const
+{
+    return busy_since_.load(std::memory_order_relaxed);
+}
+
+void MNetEventLoop::SetStage(MNetLoopStage stage)
+{
+    stage_.store(static_cast<int>(stage), std::memory_order_release);
+}
+
+int64_t MNetEventLoop::GetQueuedBytes() const
+{
+    return queued_bytes_.load(std::memory_order_relaxed);
+}
+
+void MNetEventLoop::AddQueuedBytes(int64_t delta)
+{
+    queued_bytes_.fetch_add(delta, std::memory_order_relaxed);
+}
+
+size_t MNetEventLoop::GetHighWaterCount() const
+{
+    return static_cast<size_t>(high_water_count_.load(std::memory_order_relaxed));
+}
+
+void MNetEventLoop::AddHighWaterCount(int delta)
+{
+    high_water_count_.fetch_add(delta, std::memory_order_relaxed);
+}
+
+uint64_t MNetEventLoop::GetRecentBytes(int64_t now) const
+{
+    //an idle loop blocked in epoll_wait has not decayed its counter yet
+    int64_t period = (now - stats_.decay_time.load(std::memory_order_relaxed)) / MNET_LOOP_TRAFFIC_DECAY_TIME;
+    uint64_t bytes = stats_.recent_bytes.load(std::memory_order_relaxed);
+    if (period <= 0)
+    {
+        return bytes;
+    }
+    return period < 64 ? bytes >> period : 0;
+}
+
+void MNetEventLoop::AddTrafficBytes(size_t len)
+{
+    stats_.recent_bytes.store(stats_.recent_bytes.load(std::memory_order_relaxed) + len, std::memory_order_relaxed);
+}
+
+void MNetEventLoop::AddFlush(MNetConnector *p_connector)
+{
+    if (p_connector->pp_flush_prev_)
+    {
+        return;
+    }
+    p_connector->p_flush_next_ = p_flush_head_;
+    if (p_flush_head_)
+    {
+        p_flush_head_->pp_flush_prev_ = &p_connector->p_flush_next_;
+    }
+    p_connector->pp_flush_prev_ = &p_flush_head_;
+    p_flush_head_ = p_connector;
+}
+
+void MNetEventLoop::DelFlush(MNetConnector *p_connector)
+{
+    MNetConnector **pp_prev = p_connector->pp_flush_prev_;
+    if (!pp_prev)
+    {
+        return;
+    }
+    *pp_prev = p_connector->p_flush_next_;
+    if (p_connector->p_flush_next_)
+    {
+        p_connector->p_flush_next_->pp_flush_prev_ = pp_prev;
+    }
+    p_connector->p_flush_next_ = nullptr;
+    p_connector->pp_flush_prev_ = nullptr;
+}
+
+void MNetEventLoop::FlushPending()
+{
+    //write callbacks may cork more output or free any connector of the detached list
+    while (p_flush_head_)
+    {
+        MNetConnector *p_head = p_flush_head_;
+        p_flush_head_ = nullptr;
+        p_head->pp_flush_prev_ = &p_head;
+        while (p_head)
+        {
+            p_head->Flush();
+        }
+    }
+}
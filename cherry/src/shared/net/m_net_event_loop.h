@@ -2,10 +2,38 @@
 #define _M_NET_EVENT_LOOP_H_
 
 #include <net/m_net_common.h>
+#include <net/m_net_timeout_wheel.h>
 #include <vector>
+#include <atomic>
 #include <util/m_errno.h>
 
 class MNetEvent;
+class MNetConnector;
+
+#define MNET_LOOP_TRAFFIC_DECAY_TIME 1000
+
+//read by other threads to place connections
+//padded so acceptors polling it do not share lines with the loop's own state
+struct MNetLoopStats
+{
+    char pad_front[M_NET_CACHE_LINE_SIZE];
+    //events may be added or deleted from outside the loop thread, updated with fetch_add and fetch_sub
+    std::atomic<size_t> event_count;
+    //bytes read and written, halved every MNET_LOOP_TRAFFIC_DECAY_TIME, written only by the loop thread
+    std::atomic<uint64_t> recent_bytes;
+    std::atomic<int64_t> decay_time;
+    char pad_back[M_NET_CACHE_LINE_SIZE];
+};
+
+enum class MNetLoopStage
+{
+    Poll = 0,
+    Read = 1,
+    Write = 2,
+    Error = 3,
+    Timeout = 4,
+    Callback = 5,
+};
 
 class MNetEventLoop
 {
@@ -23,11 +51,39 @@ public:
     MError DelEvent(int fd);
     MError ProcessEvents();
     MError Interrupt();
+    //monotonic milliseconds cached once per ProcessEvents
+    int64_t GetTime() const;
+    MNetTimeoutWheel& GetTimeoutWheel();
+    //read by watchdog threads, written only by the loop thread
+    uint64_t GetHeartbeat() const;
+    MNetLoopStage GetStage() const;
+    int64_t GetBusySince() const;
+    void SetStage(MNetLoopStage stage);
+    //outbound bytes queued by the connectors of this loop
+    int64_t GetQueuedBytes() const;
+    void AddQueuedBytes(int64_t delta);
+    size_t GetHighWaterCount() const;
+    void AddHighWaterCount(int delta);
+    //any thread, now is monotonic milliseconds
+    uint64_t GetRecentBytes(int64_t now) const;
+    void AddTrafficBytes(size_t len);
+    //connectors with corked output, flushed once per iteration
+    void AddFlush(MNetConnector *p_connector);
+    void DelFlush(MNetConnector *p_connector);
+    void FlushPending();
 private:
     int epoll_fd_;
     std::vector<epoll_event> event_list_;
     int interrupter_[2];
-    size_t event_count_;
+    MNetLoopStats stats_;
+    int64_t cur_time_;
+    MNetTimeoutWheel timeout_wheel_;
+    std::atomic<uint64_t> heartbeat_;
+    std::atomic<int> stage_;
+    std::atomic<int64_t> busy_since_;
+    std::atomic<int64_t> queued_bytes_;
+    std::atomic<int64_t> high_water_count_;
+    MNetConnector *p_flush_head_;
 };
 
 #endif
@@ -0,0 +1,198 @@
+#include <net/m_net_event_loop_group.h>
+#include <net/m_net_listener.h>
+#include <net/m_net_loop_placement.h>
+#include <net/m_socket.h>
+#include <util/m_logger.h>
+
+MNetEventLoopGroup::MNetEventLoopGroup(size_t single_process_events)
+    :single_process_events_(single_process_events)
+    ,p_placement_(new MNetRoundRobinPlacement())
+{
+}
+
+MNetEventLoopGroup::~MNetEventLoopGroup()
+{
+    StopAndJoin();
+    Close();
+    delete p_placement_;
+}
+
+MError MNetEventLoopGroup::Init(size_t loop_count)
+{
+    if (!loop_threads_.empty())
+    {
+        return MError::Created;
+    }
+    if (loop_count == 0)
+    {
+        return MError::Invalid;
+    }
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        MNetEventLoopThread *p_loop_thread = new MNetEventLoopThread(single_process_events_);
+        loop_threads_.push_back(p_loop_thread);
+        MError err = p_loop_thread->Init();
+        if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "init loop thread failed, index:", i);
+            return err;
+        }
+    }
+    return MError::No;
+}
+
+MError MNetEventLoopGroup::Close()
+{
+    for (auto &p_listener : listeners_)
+    {
+        p_listener->EnableAccept(false);
+        delete p_listener;
+    }
+    listeners_.clear();
+    for (auto &p_loop_thread : loop_threads_)
+    {
+        delete p_loop_thread;
+    }
+    loop_threads_.clear();
+    return MError::No;
+}
+
+MError MNetEventLoopGroup::Start()
+{
+    for (auto &p_loop_thread : loop_threads_)
+    {
+        MError err = p_loop_thread->Start();
+        if (err != MError::No)
+        {
+            return err;
+        }
+    }
+    return MError::No;
+}
+
+MError MNetEventLoopGroup::StopAndJoin()
+{
+    MError ret = MError::No;
+    for (auto &p_loop_thread : loop_threads_)
+    {
+        p_loop_thread->Stop();
+    }
+    for (auto &p_loop_thread : loop_threads_)
+    {
+        MError err = p_loop_thread->StopAndJoin();
+        if (err != MError::No)
+        {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+size_t MNetEventLoopGroup::GetLoopCount() const
+{
+    return loop_threads_.size();
+}
+
+MNetEventLoopThread* MNetEventLoopGroup::GetLoopThread(size_t index)
+{
+    if (index >= loop_threads_.size())
+    {
+        return nullptr;
+    }
+    return loop_threads_[index];
+}
+
+size_t MNetEventLoopGroup::GetLoopIndex(const MNetEventLoopThread *p_loop_thread) const
+{
+    for (size_t i = 0; i < loop_threads_.size(); ++i)
+    {
+        if (loop_threads_[i] == p_loop_thread)
+        {
+            return i;
+        }
+    }
+    return loop_threads_.size();
+}
+
+const std::vector<MNetListener*>& MNetEventLoopGroup::GetListeners() const
+{
+    return listeners_;
+}
+
+void MNetEventLoopGroup::SetPlacement(MNetLoopPlacement *p_placement)
+{
+    if (!p_placement || p_placement == p_placement_)
+    {
+        return;
+    }
+    delete p_placement_;
+    p_placement_ = p_placement;
+}
+
+MNetEventLoopThread* MNetEventLoopGroup::SelectLoopThread(uint64_t key)
+{
+    if (loop_threads_.empty())
+    {
+        return nullptr;
+    }
+    return loop_threads_[p_placement_->Select(loop_threads_, key)];
+}
+
+MError MNetEventLoopGroup::AddListener(const std::string &ip, unsigned short port
+    , const std::function<void (MNetEventLoopThread*, MSocket*)> &accept_cb, const std::function<void (MNetListener*, MError)> &error_cb
+    , int backlog, size_t single_accept_count)
+{
+    if (loop_threads_.empty() || !accept_cb)
+    {
+        return MError::Invalid;
+    }
+    //bind every socket before any loop starts accepting, so a failure leaves nothing listening
+    std::vector<MSocket*> socks;
+    for (size_t i = 0; i < loop_threads_.size(); ++i)
+    {
+        MSocket *p_sock = new MSocket();
+        MError err = p_sock->CreateNonblockReusePortListener(ip, port, backlog);
+        if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "create reuse port listener failed, port:", port);
+            delete p_sock;
+            for (auto &p_created_sock : socks)
+            {
+                delete p_created_sock;
+            }
+            return err;
+        }
+        socks.push_back(p_sock);
+    }
+    MError ret = MError::No;
+    for (size_t i = 0; i < loop_threads_.size(); ++i)
+    {
+        MNetEventLoopThread *p_loop_thread = loop_threads_[i];
+        MNetListener *p_listener = new MNetListener(socks[i], &p_loop_thread->GetEventLoop(), nullptr, nullptr, true, single_accept_count);
+        listeners_.push_back(p_listener);
+        p_listener->SetAcceptCallback(std::bind(accept_cb, p_loop_thread, std::placeholders::_1));
+        if (error_cb)
+        {
+            p_listener->SetErrorCallback(std::bind(error_cb, p_listener, std::placeholders::_1));
+        }
+        //the listener's event belongs to its loop, enable it on the loop thread
+        p_loop_thread->AddCallback(std::bind(&MNetEventLoopGroup::OnListenerEnableCallback, this, p_listener));
+        MError err = p_loop_thread->Interrupt();
+        if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "interrupt loop failed, port:", port);
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+void MNetEventLoopGroup::OnListenerEnableCallback(MNetListener *p_listener)
+{
+    MError err = p_listener->EnableAccept(true);
+    if (err != MError::No)
+    {
+        MLOG(MGetLibLogger(), MERR, "enable accept failed");
+        p_listener->OnErrorCallback(err);
+    }
+}
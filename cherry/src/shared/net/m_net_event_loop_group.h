@@ -0,0 +1,49 @@
+#ifndef _M_NET_EVENT_LOOP_GROUP_H_
+#define _M_NET_EVENT_LOOP_GROUP_H_
+
+#include <net/m_net_event_loop_thread.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+class MSocket;
+class MNetListener;
+class MNetLoopPlacement;
+
+class MNetEventLoopGroup
+{
+public:
+    explicit MNetEventLoopGroup(size_t single_process_events = 128);
+    ~MNetEventLoopGroup();
+    MNetEventLoopGroup(const MNetEventLoopGroup &) = delete;
+    MNetEventLoopGroup& operator=(const MNetEventLoopGroup &) = delete;
+public:
+    MError Init(size_t loop_count);
+    MError Close();
+    MError Start();
+    MError StopAndJoin();
+    size_t GetLoopCount() const;
+    MNetEventLoopThread* GetLoopThread(size_t index);
+    //GetLoopCount() if the thread is not in the group
+    size_t GetLoopIndex(const MNetEventLoopThread *p_loop_thread) const;
+    const std::vector<MNetListener*>& GetListeners() const;
+    //the group owns the policy, round robin by default
+    void SetPlacement(MNetLoopPlacement *p_placement);
+    //loop for a connection that is not accepted by a reuse port listener, e.g. an outgoing one
+    MNetEventLoopThread* SelectLoopThread(uint64_t key = 0);
+
+    //before or after Start, each listener is enabled by its own loop thread
+    //and a failed enable is reported through error_cb
+    MError AddListener(const std::string &ip, unsigned short port
+        , const std::function<void (MNetEventLoopThread*, MSocket*)> &accept_cb, const std::function<void (MNetListener*, MError)> &error_cb
+        , int backlog = 128, size_t single_accept_count = 128);
+public://async
+    void OnListenerEnableCallback(MNetListener *p_listener);
+private:
+    size_t single_process_events_;
+    std::vector<MNetEventLoopThread*> loop_threads_;
+    std::vector<MNetListener*> listeners_;
+    MNetLoopPlacement *p_placement_;
+};
+
+#endif
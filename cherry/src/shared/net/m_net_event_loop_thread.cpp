@@ -2,6 +2,8 @@
 
 MNetEventLoopThread::MNetEventLoopThread(size_t single_process_events)
     :event_loop_(single_process_events)
+    ,wakeup_pending_(false)
+    ,wakeup_count_(0)
 {
 }
 
@@ -47,36 +49,53 @@ MNetEventLoop& MNetEventLoopThread::GetEventLoop()
     return event_loop_;
 }
 
+m_thread_t MNetEventLoopThread::GetThreadID() const
+{
+    return MThread::GetPID();
+}
+
 size_t MNetEventLoopThread::GetEventCount() const
 {
     return event_loop_.GetEventCount();
 }
 
-void MNetEventLoopThread::AddCallback(const std::function<void ()> &cb)
+void MNetEventLoopThread::AddCallback(MInlineFunction<void ()> cb)
 {
-    std::lock_guard<std::mutex> lock(cb_mutex_);
-    cb_list_.push_back(cb);
+    cb_queue_.Push(std::move(cb));
 }
 
 MError MNetEventLoopThread::Interrupt()
 {
+    if (wakeup_pending_.exchange(true, std::memory_order_acq_rel))
+    {
+        return MError::No;
+    }
+    wakeup_count_.fetch_add(1, std::memory_order_relaxed);
     return event_loop_.Interrupt();
 }
 
+uint64_t MNetEventLoopThread::GetWakeupCount() const
+{
+    return wakeup_count_.load(std::memory_order_relaxed);
+}
+
 void MNetEventLoopThread::_Run()
 {
     event_loop_.ProcessEvents();
-    std::list<std::function<void ()> > cb_list;
+    //cleared before draining, a producer that still sees it set is drained below
+    wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+    if (!cb_queue_.Empty())
     {
-        std::lock_guard<std::mutex> lock(cb_mutex_);
-        cb_list.swap(cb_list_);
+        event_loop_.SetStage(MNetLoopStage::Callback);
     }
-    for (auto &cb : cb_list)
+    MInlineFunction<void ()> cb;
+    while (cb_queue_.Pop(cb))
     {
         if (cb)
         {
             cb();
         }
     }
+    event_loop_.FlushPending();
 }
 
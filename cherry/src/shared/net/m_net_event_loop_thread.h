@@ -3,9 +3,9 @@
 
 #include <net/m_net_event_loop.h>
 #include <thread/m_thread.h>
-#include <mutex>
-#include <functional>
-#include <list>
+#include <util/m_inline_function.h>
+#include <util/m_mpsc_queue.h>
+#include <atomic>
 
 class MNetEventLoopThread
     :private MThread
@@ -22,15 +22,20 @@ public:
     MError Stop();
     MError StopAndJoin();
     MNetEventLoop& GetEventLoop();
+    m_thread_t GetThreadID() const;
     size_t GetEventCount() const;
-    void AddCallback(const std::function<void ()> &cb);
+    //any thread, lock free
+    void AddCallback(MInlineFunction<void ()> cb);
+    //only the first call after the loop drains its callbacks wakes it up
     MError Interrupt();
+    uint64_t GetWakeupCount() const;
 private:
     virtual void _Run() override;
 private:
     MNetEventLoop event_loop_;
-    std::list<std::function<void ()> > cb_list_;
-    std::mutex cb_mutex_;
+    MMpscQueue<MInlineFunction<void ()> > cb_queue_;
+    std::atomic<bool> wakeup_pending_;
+    std::atomic<uint64_t> wakeup_count_;
 };
 
 #endif
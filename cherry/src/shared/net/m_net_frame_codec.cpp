@@ -0,0 +1,179 @@
+#include <net/m_net_frame_codec.h>
+#include <net/m_net_connector.h>
+#include <util/m_logger.h>
+
+MNetFrameCodec::MNetFrameCodec(MNetFrameHeader header, size_t max_len
+        , const std::function<void (const char*, size_t)> &message_cb)
+    :header_(header)
+    ,max_len_(max_len)
+    ,message_cb_(message_cb)
+{
+    if (header_ == MNetFrameHeader::Fixed16 && max_len_ > 0xffff)
+    {
+        max_len_ = 0xffff;
+    }
+    else if (max_len_ > 0xffffffff)
+    {
+        max_len_ = 0xffffffff;
+    }
+}
+
+MNetFrameCodec::~MNetFrameCodec()
+{
+}
+
+MNetFrameHeader MNetFrameCodec::GetHeader() const
+{
+    return header_;
+}
+
+size_t MNetFrameCodec::GetMaxLen() const
+{
+    return max_len_;
+}
+
+void MNetFrameCodec::SetMessageCallback(const std::function<void (const char*, size_t)> &message_cb)
+{
+    message_cb_ = message_cb;
+}
+
+size_t MNetFrameCodec::EncodeHeader(size_t len, char *p_header) const
+{
+    unsigned char *p = reinterpret_cast<unsigned char*>(p_header);
+    switch (header_)
+    {
+    case MNetFrameHeader::Fixed16:
+        p[0] = static_cast<unsigned char>(len >> 8);
+        p[1] = static_cast<unsigned char>(len);
+        return 2;
+    case MNetFrameHeader::Fixed32:
+        p[0] = static_cast<unsigned char>(len >> 24);
+        p[1] = static_cast<unsigned char>(len >> 16);
+        p[2] = static_cast<unsigned char>(len >> 8);
+        p[3] = static_cast<unsigned char>(len);
+        return 4;
+    case MNetFrameHeader::Varint:
+        {
+            size_t count = 0;
+            while (len >= 0x80)
+            {
+                p[count++] = static_cast<unsigned char>(len | 0x80);
+                len >>= 7;
+            }
+            p[count++] = static_cast<unsigned char>(len);
+            return count;
+        }
+    }
+    return 0;
+}
+
+MError MNetFrameCodec::DecodeHeader(const char *p_buf, size_t buf_len, size_t &header_len, size_t &len) const
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(p_buf);
+    switch (header_)
+    {
+    case MNetFrameHeader::Fixed16:
+        if (buf_len < 2)
+        {
+            return MError::NoData;
+        }
+        header_len = 2;
+        len = (static_cast<size_t>(p[0]) << 8) | p[1];
+        break;
+    case MNetFrameHeader::Fixed32:
+        if (buf_len < 4)
+        {
+            return MError::NoData;
+        }
+        header_len = 4;
+        len = (static_cast<size_t>(p[0]) << 24) | (static_cast<size_t>(p[1]) << 16)
+            | (static_cast<size_t>(p[2]) << 8) | p[3];
+        break;
+    case MNetFrameHeader::Varint:
+        {
+            len = 0;
+            size_t i = 0;
+            while (true)
+            {
+                if (i >= buf_len)
+                {
+                    return MError::NoData;
+                }
+                if (i >= MNET_FRAME_MAX_HEADER_LEN)
+                {
+                    return MError::Invalid;
+                }
+                len |= static_cast<size_t>(p[i] & 0x7f) << (7 * i);
+                if (!(p[i++] & 0x80))
+                {
+                    break;
+                }
+            }
+            header_len = i;
+        }
+        break;
+    }
+    if (len > max_len_)
+    {
+        return MError::Overflow;
+    }
+    return MError::No;
+}
+
+MError MNetFrameCodec::Decode(MNetConnector *p_connector)
+{
+    char header[MNET_FRAME_MAX_HEADER_LEN];
+    while (true)
+    {
+        size_t buf_len = p_connector->GetReadBufLen();
+        size_t peek_len = buf_len < MNET_FRAME_MAX_HEADER_LEN ? buf_len : MNET_FRAME_MAX_HEADER_LEN;
+        if (p_connector->PeekReadBuf(header, peek_len) != MError::No)
+        {
+            return MError::No;
+        }
+        size_t header_len = 0;
+        size_t len = 0;
+        MError err = DecodeHeader(header, peek_len, header_len, len);
+        if (err == MError::NoData)
+        {
+            return MError::No;
+        }
+        if (err != MError::No)
+        {
+            MLOG(MGetLibLogger(), MERR, "decode frame header failed err:", static_cast<int>(err));
+            return err;
+        }
+        if (buf_len < header_len + len)
+        {
+            return MError::No;
+        }
+        const char *p_data = p_connector->GetReadBufView(header_len, len);
+        if (!p_data)
+        {
+            scratch_.resize(header_len + len);
+            p_connector->PeekReadBuf(&scratch_[0], scratch_.size());
+            p_data = scratch_.data() + header_len;
+        }
+        if (message_cb_)
+        {
+            message_cb_(p_data, len);
+        }
+        p_connector->SkipReadBuf(header_len + len);
+    }
+}
+
+MError MNetFrameCodec::Write(MNetConnector *p_connector, const char *p_buf, size_t len)
+{
+    if (len > max_len_)
+    {
+        MLOG(MGetLibLogger(), MERR, "frame len:", len, " max len:", max_len_);
+        return MError::Overflow;
+    }
+    char header[MNET_FRAME_MAX_HEADER_LEN];
+    iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = EncodeHeader(len, header);
+    iov[1].iov_base = const_cast<char*>(p_buf);
+    iov[1].iov_len = len;
+    return p_connector->WriteBuf(iov, 2);
+}
@@ -0,0 +1,49 @@
+#ifndef _M_NET_FRAME_CODEC_H_
+#define _M_NET_FRAME_CODEC_H_
+
+#include <util/m_errno.h>
+#include <functional>
+#include <string>
+#include <cstddef>
+
+class MNetConnector;
+
+#define MNET_FRAME_MAX_HEADER_LEN 5
+
+enum class MNetFrameHeader
+{
+    Fixed16 = 0,
+    Fixed32 = 1,
+    Varint = 2,
+};
+
+//length prefixed framing, fixed headers are big endian, varint is LEB128 up to 32 bits
+class MNetFrameCodec
+{
+public:
+    explicit MNetFrameCodec(MNetFrameHeader header = MNetFrameHeader::Fixed16, size_t max_len = 65535
+        , const std::function<void (const char*, size_t)> &message_cb = nullptr);
+    ~MNetFrameCodec();
+    MNetFrameCodec(const MNetFrameCodec &) = delete;
+    MNetFrameCodec& operator=(const MNetFrameCodec &) = delete;
+public:
+    MNetFrameHeader GetHeader() const;
+    size_t GetMaxLen() const;
+    //the view is only valid during the call, the callback must not free the connector
+    void SetMessageCallback(const std::function<void (const char*, size_t)> &message_cb);
+
+    //deliver every complete frame of the read buffer, Overflow or Invalid mean the stream is broken
+    MError Decode(MNetConnector *p_connector);
+    MError Write(MNetConnector *p_connector, const char *p_buf, size_t len);
+
+    size_t EncodeHeader(size_t len, char *p_header) const;
+    //returns NoData until the whole header is buffered
+    MError DecodeHeader(const char *p_buf, size_t buf_len, size_t &header_len, size_t &len) const;
+private:
+    MNetFrameHeader header_;
+    size_t max_len_;
+    std::function<void (const char*, size_t)> message_cb_;
+    std::string scratch_;
+};
+
+#endif
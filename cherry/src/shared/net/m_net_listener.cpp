@@ -2,6 +2,10 @@
 #include <net/m_socket.h>
 #include <net/m_net_event_loop.h>
 #include <util/m_logger.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
 
 MNetListener::MNetListener(MSocket *p_sock, MNetEventLoop *p_event_loop
     , const std::function<void (MSocket*)> &accept_cb, const std::function<void (MError)> &error_cb
@@ -12,7 +16,15 @@ MNetListener::MNetListener(MSocket *p_sock, MNetEventLoop *p_event_loop
     ,accept_cb_(accept_cb)
     ,error_cb_(error_cb)
     ,need_free_sock_(need_free_sock)
-    ,single_accept_count_(single_accept_count)
+    ,single_accept_count_(single_accept_count > 0 ? single_accept_count : 1)
+    ,accept_budget_(single_accept_count_)
+    ,accept_count_(0)
+    ,wakeup_count_(0)
+    ,empty_wakeup_count_(0)
+    ,budget_exhausted_count_(0)
+    ,error_count_(0)
+    ,max_queue_len_(0)
+    ,backlog_(0)
 {
 }
 
@@ -81,9 +93,15 @@ bool MNetListener::GetNeedFreeSock() const
     return need_free_sock_;
 }
 
+void MNetListener::SetBatchAcceptCallback(const std::function<void (MNetAcceptInfo*, size_t)> &batch_accept_cb)
+{
+    batch_accept_cb_ = batch_accept_cb;
+}
+
 void MNetListener::SetSingleAcceptCount(size_t count)
 {
-    single_accept_count_ = count;
+    single_accept_count_ = count > 0 ? count : 1;
+    accept_budget_.store(single_accept_count_, std::memory_order_relaxed);
 }
 
 size_t MNetListener::GetSingleAcceptCount() const
@@ -105,34 +123,145 @@ MError MNetListener::EnableAccept(bool enable)
     }
 }
 
+MNetListenerStats MNetListener::GetStats() const
+{
+    MNetListenerStats stats;
+    stats.accept_count = accept_count_.load(std::memory_order_relaxed);
+    stats.wakeup_count = wakeup_count_.load(std::memory_order_relaxed);
+    stats.empty_wakeup_count = empty_wakeup_count_.load(std::memory_order_relaxed);
+    stats.budget_exhausted_count = budget_exhausted_count_.load(std::memory_order_relaxed);
+    stats.error_count = error_count_.load(std::memory_order_relaxed);
+    stats.accept_budget = accept_budget_.load(std::memory_order_relaxed);
+    stats.max_queue_len = max_queue_len_.load(std::memory_order_relaxed);
+    stats.backlog = backlog_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+MError MNetListener::GetListenOverflows(uint64_t &overflows, uint64_t &drops)
+{
+    std::ifstream file("/proc/net/netstat");
+    if (!file)
+    {
+        return MError::NotSupport;
+    }
+    std::string names;
+    std::string values;
+    while (std::getline(file, names) && std::getline(file, values))
+    {
+        if (names.compare(0, 7, "TcpExt:") != 0)
+        {
+            continue;
+        }
+        std::istringstream name_stream(names);
+        std::istringstream value_stream(values);
+        std::string name;
+        uint64_t value = 0;
+        bool found_overflows = false;
+        bool found_drops = false;
+        name_stream >> name;
+        value_stream >> name;
+        while (name_stream >> name && value_stream >> value)
+        {
+            if (name == "ListenOverflows")
+            {
+                overflows = value;
+                found_overflows = true;
+            }
+            else if (name == "ListenDrops")
+            {
+                drops = value;
+                found_drops = true;
+            }
+        }
+        return found_overflows && found_drops ? MError::No : MError::NoData;
+    }
+    return MError::NoData;
+}
+
 void MNetListener::OnAcceptCallback()
 {
-    if (!accept_cb_)
+    if (!accept_cb_ && !batch_accept_cb_)
     {
         return;
     }
-    size_t count = single_accept_count_;
-    while (count--)
+    wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+    size_t budget = accept_budget_.load(std::memory_order_relaxed);
+    size_t accepted = 0;
+    size_t batch_count = 0;
+    MError err = MError::No;
+    while (accepted < budget)
     {
-        MSocket *p_conn_sock = new MSocket();
-        if (!p_conn_sock)
+        MNetAcceptInfo &info = accept_list_[batch_count];
+        err = p_sock_->AcceptNonblock(info.fd, info.addr);
+        if (err == MError::InterruptedSysCall)
         {
-            OnErrorCallback(MError::OutOfMemory);
-            return;
+            continue;
         }
-        MError err = p_sock_->Accept(*p_conn_sock);
         if (err != MError::No)
         {
-            delete p_conn_sock;
-            if (err != MError::Again
-                && err != MError::InterruptedSysCall)
+            break;
+        }
+        ++accepted;
+        if (batch_accept_cb_)
+        {
+            if (++batch_count == MNET_LISTENER_ACCEPT_BATCH)
             {
-                OnErrorCallback(err);
+                batch_accept_cb_(accept_list_, batch_count);
+                batch_count = 0;
             }
-            return;
+            continue;
+        }
+        MSocket *p_conn_sock = new MSocket();
+        if (p_conn_sock->AttachAccepted(info.fd, info.addr) != MError::No)
+        {
+            delete p_conn_sock;
+            continue;
         }
         accept_cb_(p_conn_sock);
     }
+    if (batch_count > 0)
+    {
+        batch_accept_cb_(accept_list_, batch_count);
+    }
+    accept_count_.fetch_add(accepted, std::memory_order_relaxed);
+    UpdateAcceptBudget(accepted);
+    if (err != MError::No && err != MError::Again)
+    {
+        error_count_.fetch_add(1, std::memory_order_relaxed);
+        OnErrorCallback(err);
+    }
+}
+
+void MNetListener::UpdateAcceptBudget(size_t accepted)
+{
+    size_t budget = accept_budget_.load(std::memory_order_relaxed);
+    if (accepted == 0)
+    {
+        empty_wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (accepted >= budget)
+    {
+        //level triggered, the rest of the queue wakes us up again next iteration
+        budget_exhausted_count_.fetch_add(1, std::memory_order_relaxed);
+        unsigned queue_len = 0;
+        unsigned backlog = 0;
+        if (p_sock_->GetAcceptQueue(queue_len, backlog) == MError::No)
+        {
+            if (queue_len > max_queue_len_.load(std::memory_order_relaxed))
+            {
+                max_queue_len_.store(queue_len, std::memory_order_relaxed);
+            }
+            backlog_.store(backlog, std::memory_order_relaxed);
+        }
+        if (budget < MNET_LISTENER_MAX_ACCEPT_BUDGET)
+        {
+            accept_budget_.store(std::min<size_t>(budget * 2, MNET_LISTENER_MAX_ACCEPT_BUDGET), std::memory_order_relaxed);
+        }
+    }
+    else if (accepted < budget / 4 && budget > single_accept_count_)
+    {
+        accept_budget_.store(std::max(budget / 2, single_accept_count_), std::memory_order_relaxed);
+    }
 }
 
 void MNetListener::OnErrorCallback(MError err)
@@ -2,10 +2,36 @@
 #define _M_NET_LISTENER_H_
 
 #include <net/m_net_event.h>
+#include <netinet/in.h>
+#include <atomic>
 
 class MSocket;
 class MNetEventLoop;
 
+#define MNET_LISTENER_ACCEPT_BATCH      64
+#define MNET_LISTENER_MAX_ACCEPT_BUDGET 1024
+
+//an accepted nonblocking close-on-exec fd, the callback owns it
+struct MNetAcceptInfo
+{
+    int fd;
+    sockaddr_in addr;
+};
+
+struct MNetListenerStats
+{
+    uint64_t accept_count;
+    uint64_t wakeup_count;
+    uint64_t empty_wakeup_count;
+    //wakeups that stopped at the budget with connections still queued
+    uint64_t budget_exhausted_count;
+    uint64_t error_count;
+    size_t accept_budget;
+    //deepest accept queue seen when the budget ran out, and its limit
+    unsigned max_queue_len;
+    unsigned backlog;
+};
+
 class MNetListener
 {
 public:
@@ -27,14 +53,24 @@ public:
     std::function<void (MError)>& GetErrorCallback();
     void SetNeedFreeSock(bool need);
     bool GetNeedFreeSock() const;
+    //raw fds handed over up to MNET_LISTENER_ACCEPT_BATCH at a time, no MSocket is allocated
+    //takes precedence over the accept callback
+    void SetBatchAcceptCallback(const std::function<void (MNetAcceptInfo*, size_t)> &batch_accept_cb);
+    //the least accepts per wakeup, the budget doubles up to MNET_LISTENER_MAX_ACCEPT_BUDGET
+    //while the accept queue keeps it busy and shrinks back once it drains
     void SetSingleAcceptCount(size_t count);
     size_t GetSingleAcceptCount() const;
+    //any thread
+    MNetListenerStats GetStats() const;
+    //system wide TcpExt ListenOverflows and ListenDrops from /proc/net/netstat
+    static MError GetListenOverflows(uint64_t &overflows, uint64_t &drops);
 
     MError EnableAccept(bool enable);
 public:
     void OnAcceptCallback();
     void OnErrorCallback(MError err);
 private:
+    void UpdateAcceptBudget(size_t accepted);
     MSocket *p_sock_;
     MNetEvent event_;
     MNetEventLoop *p_event_loop_;
@@ -42,6 +78,16 @@ private:
     std::function<void (MError)> error_cb_;
     bool need_free_sock_;
     size_t single_accept_count_;
+    std::function<void (MNetAcceptInfo*, size_t)> batch_accept_cb_;
+    MNetAcceptInfo accept_list_[MNET_LISTENER_ACCEPT_BATCH];
+    std::atomic<size_t> accept_budget_;
+    std::atomic<uint64_t> accept_count_;
+    std::atomic<uint64_t> wakeup_count_;
+    std::atomic<uint64_t> empty_wakeup_count_;
+    std::atomic<uint64_t> budget_exhausted_count_;
+    std::atomic<uint64_t> error_count_;
+    std::atomic<unsigned> max_queue_len_;
+    std::atomic<unsigned> backlog_;
 };
 
 #endif
@@ -0,0 +1,144 @@
+#include <net/m_net_loop_placement.h>
+#include <net/m_net_event_loop_thread.h>
+#include <util/m_time.h>
+#include <algorithm>
+
+static uint64_t MixHash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t GetLoopEventCount(MNetEventLoopThread *p_loop_thread, int64_t now)
+{
+    return p_loop_thread->GetEventCount();
+}
+
+static uint64_t GetLoopRecentBytes(MNetEventLoopThread *p_loop_thread, int64_t now)
+{
+    return p_loop_thread->GetEventLoop().GetRecentBytes(now);
+}
+
+MNetLoopPlacement::MNetLoopPlacement()
+    :seed_(0)
+{
+}
+
+MNetLoopPlacement::~MNetLoopPlacement()
+{
+}
+
+uint64_t MNetLoopPlacement::HashKey(const std::string &key)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (auto c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t MNetLoopPlacement::SelectMin(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t (*score_fn)(MNetEventLoopThread*, int64_t))
+{
+    int64_t now = MTime::GetMonotonicTime();
+    size_t count = loop_threads.size();
+    if (count <= MNET_PLACEMENT_SCAN_LIMIT)
+    {
+        size_t index = 0;
+        uint64_t min_score = score_fn(loop_threads[0], now);
+        for (size_t i = 1; i < count; ++i)
+        {
+            uint64_t score = score_fn(loop_threads[i], now);
+            if (score < min_score)
+            {
+                index = i;
+                min_score = score;
+            }
+        }
+        return index;
+    }
+    uint64_t random = MixHash(seed_.fetch_add(1, std::memory_order_relaxed));
+    size_t first = static_cast<size_t>(random % count);
+    size_t second = static_cast<size_t>((random >> 32) % (count - 1));
+    if (second >= first)
+    {
+        ++second;
+    }
+    return score_fn(loop_threads[second], now) < score_fn(loop_threads[first], now) ? second : first;
+}
+
+MNetRoundRobinPlacement::MNetRoundRobinPlacement()
+    :next_(0)
+{
+}
+
+MNetRoundRobinPlacement::~MNetRoundRobinPlacement()
+{
+}
+
+size_t MNetRoundRobinPlacement::Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key)
+{
+    return next_.fetch_add(1, std::memory_order_relaxed) % loop_threads.size();
+}
+
+MNetLeastConnectionPlacement::MNetLeastConnectionPlacement()
+{
+}
+
+MNetLeastConnectionPlacement::~MNetLeastConnectionPlacement()
+{
+}
+
+size_t MNetLeastConnectionPlacement::Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key)
+{
+    return SelectMin(loop_threads, GetLoopEventCount);
+}
+
+MNetLeastTrafficPlacement::MNetLeastTrafficPlacement()
+{
+}
+
+MNetLeastTrafficPlacement::~MNetLeastTrafficPlacement()
+{
+}
+
+size_t MNetLeastTrafficPlacement::Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key)
+{
+    return SelectMin(loop_threads, GetLoopRecentBytes);
+}
+
+MNetConsistentHashPlacement::MNetConsistentHashPlacement(size_t loop_count, size_t virtual_nodes)
+    :loop_count_(loop_count)
+{
+    ring_.reserve(loop_count * virtual_nodes);
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+        for (size_t j = 0; j < virtual_nodes; ++j)
+        {
+            ring_.push_back(std::make_pair(MixHash((static_cast<uint64_t>(i) << 32) | j), i));
+        }
+    }
+    std::sort(ring_.begin(), ring_.end());
+}
+
+MNetConsistentHashPlacement::~MNetConsistentHashPlacement()
+{
+}
+
+size_t MNetConsistentHashPlacement::Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key)
+{
+    uint64_t hash = MixHash(key);
+    if (ring_.empty() || loop_count_ != loop_threads.size())
+    {
+        return static_cast<size_t>(hash % loop_threads.size());
+    }
+    auto it = std::lower_bound(ring_.begin(), ring_.end(), std::make_pair(hash, static_cast<size_t>(0)));
+    if (it == ring_.end())
+    {
+        it = ring_.begin();
+    }
+    return it->second;
+}
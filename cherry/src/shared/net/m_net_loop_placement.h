@@ -0,0 +1,86 @@
+#ifndef _M_NET_LOOP_PLACEMENT_H_
+#define _M_NET_LOOP_PLACEMENT_H_
+
+#include <util/m_type_define.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <utility>
+
+class MNetEventLoopThread;
+
+//loops beyond this count are sampled with two random choices instead of scanned
+#define MNET_PLACEMENT_SCAN_LIMIT      8
+#define MNET_PLACEMENT_VIRTUAL_NODES   64
+
+//chooses the loop thread of a new connection, Select may be called from any thread
+class MNetLoopPlacement
+{
+public:
+    MNetLoopPlacement();
+    virtual ~MNetLoopPlacement();
+    MNetLoopPlacement(const MNetLoopPlacement &) = delete;
+    MNetLoopPlacement& operator=(const MNetLoopPlacement &) = delete;
+public:
+    //key identifies the client, e.g. HashKey of its ip or account
+    //returns an index into loop_threads, which must not be empty
+    virtual size_t Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key) = 0;
+public:
+    static uint64_t HashKey(const std::string &key);
+protected:
+    //lowest score of a full scan, or of two random choices for many loops
+    size_t SelectMin(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t (*score_fn)(MNetEventLoopThread*, int64_t));
+private:
+    std::atomic<uint64_t> seed_;
+};
+
+class MNetRoundRobinPlacement
+    :public MNetLoopPlacement
+{
+public:
+    MNetRoundRobinPlacement();
+    virtual ~MNetRoundRobinPlacement();
+public:
+    virtual size_t Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key) override;
+private:
+    std::atomic<size_t> next_;
+};
+
+//fewest registered fds
+class MNetLeastConnectionPlacement
+    :public MNetLoopPlacement
+{
+public:
+    MNetLeastConnectionPlacement();
+    virtual ~MNetLeastConnectionPlacement();
+public:
+    virtual size_t Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key) override;
+};
+
+//fewest bytes moved recently, see MNET_LOOP_TRAFFIC_DECAY_TIME
+class MNetLeastTrafficPlacement
+    :public MNetLoopPlacement
+{
+public:
+    MNetLeastTrafficPlacement();
+    virtual ~MNetLeastTrafficPlacement();
+public:
+    virtual size_t Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key) override;
+};
+
+//the same key keeps landing on the same loop, and only 1/n of the keys move when a loop is added
+class MNetConsistentHashPlacement
+    :public MNetLoopPlacement
+{
+public:
+    MNetConsistentHashPlacement(size_t loop_count, size_t virtual_nodes = MNET_PLACEMENT_VIRTUAL_NODES);
+    virtual ~MNetConsistentHashPlacement();
+public:
+    virtual size_t Select(const std::vector<MNetEventLoopThread*> &loop_threads, uint64_t key) override;
+private:
+    size_t loop_count_;
+    //sorted by hash
+    std::vector<std::pair<uint64_t, size_t> > ring_;
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include <net/m_net_loop_watchdog.h>
+#include <net/m_net_event_loop_thread.h>
+#include <util/m_logger.h>
+#include <util/m_time.h>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <execinfo.h>
+#include <signal.h>
+#include <unistd.h>
+
+//one capture at a time across all watchdogs, a handler may only write the frames after claiming
+//the armed sequence, so a late signal from an abandoned capture can not touch a later one
+static std::mutex s_capture_mutex;
+static int s_capture_next_seq = 0;
+static void *s_capture_frames[MNET_WATCHDOG_MAX_FRAMES];
+static std::atomic<int> s_capture_count(0);
+static std::atomic<int> s_capture_seq(0);
+static std::atomic<int> s_capture_done_seq(0);
+
+MNetLoopWatchdog::MNetLoopWatchdog()
+    :stall_cb_(nullptr)
+    ,stall_time_(500)
+    ,check_interval_(100)
+    ,running_(false)
+{
+}
+
+MNetLoopWatchdog::~MNetLoopWatchdog()
+{
+    StopAndJoin();
+}
+
+MError MNetLoopWatchdog::AddLoop(MNetEventLoopThread *p_loop_thread)
+{
+    if (!p_loop_thread)
+    {
+        MLOG(MGetLibLogger(), MERR, "loop thread is null");
+        return MError::Invalid;
+    }
+    if (running_)
+    {
+        MLOG(MGetLibLogger(), MERR, "watchdog is running");
+        return MError::Running;
+    }
+    MLoopWatch watch;
+    watch.p_loop_thread = p_loop_thread;
+    watch.stall_heartbeat = 0;
+    watch.stall_since = -1;
+    loops_.push_back(watch);
+    return MError::No;
+}
+
+size_t MNetLoopWatchdog::GetLoopCount() const
+{
+    return loops_.size();
+}
+
+MError MNetLoopWatchdog::Start(int64_t stall_time, int64_t check_interval)
+{
+    if (running_)
+    {
+        return MError::Running;
+    }
+    if (stall_time <= 0 || check_interval <= 0)
+    {
+        MLOG(MGetLibLogger(), MERR, "invalid stall time:", stall_time, " check interval:", check_interval);
+        return MError::Invalid;
+    }
+    MError err = InstallSignalHandler();
+    if (err != MError::No)
+    {
+        return err;
+    }
+    stall_time_ = stall_time;
+    check_interval_ = check_interval;
+    err = MThread::Start();
+    if (err != MError::No)
+    {
+        return err;
+    }
+    running_ = true;
+    return MError::No;
+}
+
+MError MNetLoopWatchdog::StopAndJoin()
+{
+    if (!running_)
+    {
+        return MError::No;
+    }
+    MError err = MThread::StopAndJoin();
+    running_ = false;
+    int64_t now = MTime::GetMonotonicTime();
+    for (auto &watch : loops_)
+    {
+        EndStall(watch, now);
+    }
+    return err;
+}
+
+void MNetLoopWatchdog::SetStallCallback(const std::function<void (const MNetLoopStallInfo&)> &stall_cb)
+{
+    stall_cb_ = stall_cb;
+}
+
+MNetLoopWatchdogStats MNetLoopWatchdog::GetStats(size_t loop_id) const
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (loop_id >= loops_.size())
+    {
+        return MNetLoopWatchdogStats();
+    }
+    return loops_[loop_id].stats;
+}
+
+const char* MNetLoopWatchdog::GetStageName(MNetLoopStage stage)
+{
+    switch (stage)
+    {
+    case MNetLoopStage::Poll:
+        return "poll";
+    case MNetLoopStage::Read:
+        return "read";
+    case MNetLoopStage::Write:
+        return "write";
+    case MNetLoopStage::Error:
+        return "error";
+    case MNetLoopStage::Timeout:
+        return "timeout";
+    case MNetLoopStage::Callback:
+        return "callback";
+    }
+    return "unknown";
+}
+
+void MNetLoopWatchdog::_Run()
+{
+    usleep(static_cast<useconds_t>(check_interval_ * 1000));
+    int64_t now = MTime::GetMonotonicTime();
+    for (size_t i = 0; i < loops_.size(); ++i)
+    {
+        Check(i, now);
+    }
+}
+
+void MNetLoopWatchdog::Check(size_t loop_id, int64_t now)
+{
+    MLoopWatch &watch = loops_[loop_id];
+    MNetEventLoop &loop = watch.p_loop_thread->GetEventLoop();
+    uint64_t heartbeat = loop.GetHeartbeat();
+    MNetLoopStage stage = loop.GetStage();
+    if (watch.stall_since >= 0 && (heartbeat != watch.stall_heartbeat || stage == MNetLoopStage::Poll))
+    {
+        EndStall(watch, now);
+    }
+    if (stage == MNetLoopStage::Poll || watch.stall_since >= 0)
+    {
+        return;
+    }
+    int64_t busy_since = loop.GetBusySince();
+    if (now - busy_since < stall_time_)
+    {
+        return;
+    }
+    watch.stall_heartbeat = heartbeat;
+    watch.stall_since = busy_since;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ++watch.stats.stall_count;
+        watch.stats.stalling = true;
+    }
+    Report(loop_id, stage, now - busy_since);
+}
+
+void MNetLoopWatchdog::EndStall(MLoopWatch &watch, int64_t now)
+{
+    if (watch.stall_since < 0)
+    {
+        return;
+    }
+    int64_t stall_time = now - watch.stall_since;
+    watch.stall_since = -1;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    watch.stats.total_stall_time += stall_time;
+    if (stall_time > watch.stats.max_stall_time)
+    {
+        watch.stats.max_stall_time = stall_time;
+    }
+    watch.stats.stall_histogram.Record(stall_time);
+    watch.stats.stalling = false;
+}
+
+void MNetLoopWatchdog::Report(size_t loop_id, MNetLoopStage stage, int64_t stall_time)
+{
+    MNetLoopStallInfo info;
+    info.loop_id = loop_id;
+    info.stage = stage;
+    info.stall_time = stall_time;
+    if (!CaptureStack(loops_[loop_id].p_loop_thread->GetThreadID(), info.stack))
+    {
+        MLOG(MGetLibLogger(), MWARN, "capture stack of loop ", loop_id, " failed");
+    }
+    if (stall_cb_)
+    {
+        stall_cb_(info);
+        return;
+    }
+    MLOG(MGetLibLogger(), MERR, "loop ", loop_id, " stalled ", stall_time, "ms in ", GetStageName(stage));
+    for (size_t i = 0; i < info.stack.size(); ++i)
+    {
+        MLOG(MGetLibLogger(), MERR, "  #", i, " ", info.stack[i]);
+    }
+}
+
+MError MNetLoopWatchdog::InstallSignalHandler()
+{
+    static std::once_flag once;
+    static MError err = MError::No;
+    std::call_once(once, []()
+    {
+        //backtrace loads libgcc lazily, do it here instead of inside the handler
+        void *p_frame = nullptr;
+        backtrace(&p_frame, 1);
+        struct sigaction sa;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART | SA_SIGINFO;
+        sa.sa_sigaction = &MNetLoopWatchdog::OnCaptureSignal;
+        if (sigaction(MNET_WATCHDOG_SIGNAL, &sa, nullptr) != 0)
+        {
+            MLOG(MGetLibLogger(), MERR, "sigaction failed errno:", errno);
+            err = MError::Unknown;
+        }
+    });
+    return err;
+}
+
+void MNetLoopWatchdog::OnCaptureSignal(int sig, siginfo_t *p_info, void *p_context)
+{
+    int seq = p_info->si_value.sival_int;
+    //claimed as -seq, the capturing thread waits for the frames instead of giving up
+    if (seq <= 0 || !s_capture_seq.compare_exchange_strong(seq, -seq, std::memory_order_acquire))
+    {
+        return;
+    }
+    int saved_errno = errno;
+    s_capture_count.store(backtrace(s_capture_frames, MNET_WATCHDOG_MAX_FRAMES), std::memory_order_relaxed);
+    s_capture_done_seq.store(seq, std::memory_order_release);
+    errno = saved_errno;
+}
+
+bool MNetLoopWatchdog::CaptureStack(m_thread_t tid, std::vector<std::string> &stack)
+{
+    stack.clear();
+    if (tid == 0)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(s_capture_mutex);
+    if (s_capture_next_seq == INT_MAX)
+    {
+        s_capture_next_seq = 0;
+    }
+    int seq = ++s_capture_next_seq;
+    s_capture_seq.store(seq, std::memory_order_release);
+    sigval value;
+    value.sival_int = seq;
+    if (pthread_sigqueue(tid, MNET_WATCHDOG_SIGNAL, value) != 0)
+    {
+        s_capture_seq.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    int64_t deadline = MTime::GetMonotonicTime() + MNET_WATCHDOG_CAPTURE_TIME;
+    while (s_capture_done_seq.load(std::memory_order_acquire) != seq)
+    {
+        if (MTime::GetMonotonicTime() >= deadline)
+        {
+            int armed_seq = seq;
+            if (s_capture_seq.compare_exchange_strong(armed_seq, 0, std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+        usleep(1000);
+    }
+    s_capture_seq.store(0, std::memory_order_relaxed);
+    int count = s_capture_count.load(std::memory_order_relaxed);
+    char **pp_symbols = backtrace_symbols(s_capture_frames, count);
+    if (!pp_symbols)
+    {
+        return false;
+    }
+    //skip the signal handler and the signal trampoline
+    for (int i = 2; i < count; ++i)
+    {
+        stack.push_back(pp_symbols[i]);
+    }
+    free(pp_symbols);
+    return true;
+}
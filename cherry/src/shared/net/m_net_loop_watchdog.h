@@ -0,0 +1,86 @@
+#ifndef _M_NET_LOOP_WATCHDOG_H_
+#define _M_NET_LOOP_WATCHDOG_H_
+
+#include <net/m_net_event_loop.h>
+#include <thread/m_thread.h>
+#include <util/m_histogram.h>
+#include <signal.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class MNetEventLoopThread;
+
+#define MNET_WATCHDOG_SIGNAL        SIGUSR2
+#define MNET_WATCHDOG_MAX_FRAMES    64
+#define MNET_WATCHDOG_CAPTURE_TIME  100
+
+struct MNetLoopStallInfo
+{
+    size_t loop_id;
+    MNetLoopStage stage;
+    int64_t stall_time;
+    std::vector<std::string> stack;
+};
+
+struct MNetLoopWatchdogStats
+{
+    MNetLoopWatchdogStats()
+        :stall_count(0)
+        ,total_stall_time(0)
+        ,max_stall_time(0)
+        ,stalling(false)
+    {
+    }
+    uint64_t stall_count;
+    int64_t total_stall_time;
+    int64_t max_stall_time;
+    bool stalling;
+    MHistogram stall_histogram;
+};
+
+class MNetLoopWatchdog
+    :private MThread
+{
+    struct MLoopWatch
+    {
+        MNetEventLoopThread *p_loop_thread;
+        uint64_t stall_heartbeat;
+        int64_t stall_since;
+        MNetLoopWatchdogStats stats;
+    };
+public:
+    MNetLoopWatchdog();
+    virtual ~MNetLoopWatchdog();
+    MNetLoopWatchdog(const MNetLoopWatchdog &) = delete;
+    MNetLoopWatchdog& operator=(const MNetLoopWatchdog &) = delete;
+public:
+    //loops must be added before Start, the loop id is the add order
+    MError AddLoop(MNetEventLoopThread *p_loop_thread);
+    size_t GetLoopCount() const;
+    //stall_time: milliseconds a loop may stay out of epoll_wait before it is reported
+    MError Start(int64_t stall_time = 500, int64_t check_interval = 100);
+    MError StopAndJoin();
+    //called on the watchdog thread, logs the stall when not set
+    void SetStallCallback(const std::function<void (const MNetLoopStallInfo&)> &stall_cb);
+    MNetLoopWatchdogStats GetStats(size_t loop_id) const;
+    static const char* GetStageName(MNetLoopStage stage);
+private:
+    virtual void _Run() override;
+    void Check(size_t loop_id, int64_t now);
+    void EndStall(MLoopWatch &watch, int64_t now);
+    void Report(size_t loop_id, MNetLoopStage stage, int64_t stall_time);
+    static MError InstallSignalHandler();
+    static void OnCaptureSignal(int sig, siginfo_t *p_info, void *p_context);
+    static bool CaptureStack(m_thread_t tid, std::vector<std::string> &stack);
+private:
+    std::vector<MLoopWatch> loops_;
+    mutable std::mutex stats_mutex_;
+    std::function<void (const MNetLoopStallInfo&)> stall_cb_;
+    int64_t stall_time_;
+    int64_t check_interval_;
+    bool running_;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include <net/m_net_timeout_wheel.h>
+#include <net/m_net_connector.h>
+#include <cstring>
+
+MNetTimeoutWheel::MNetTimeoutWheel()
+    :tick_time_(MNET_TIMEOUT_WHEEL_TICK)
+    ,cur_tick_(0)
+    ,count_(0)
+{
+    memset(slots_, 0, sizeof(slots_));
+}
+
+MNetTimeoutWheel::~MNetTimeoutWheel()
+{
+    Clear();
+}
+
+void MNetTimeoutWheel::Init(int64_t now, int64_t tick_time)
+{
+    Clear();
+    tick_time_ = tick_time > 0 ? tick_time : MNET_TIMEOUT_WHEEL_TICK;
+    cur_tick_ = now / tick_time_;
+}
+
+void MNetTimeoutWheel::Clear()
+{
+    for (int i = 0; i < MNET_TIMEOUT_WHEEL_SIZE; ++i)
+    {
+        while (slots_[i])
+        {
+            Del(slots_[i]);
+        }
+    }
+    count_ = 0;
+}
+
+bool MNetTimeoutWheel::Empty() const
+{
+    return count_ == 0;
+}
+
+size_t MNetTimeoutWheel::GetCount() const
+{
+    return count_;
+}
+
+int64_t MNetTimeoutWheel::GetTickTime() const
+{
+    return tick_time_;
+}
+
+int MNetTimeoutWheel::GetWaitTime(int64_t now) const
+{
+    if (count_ == 0)
+    {
+        return -1;
+    }
+    int64_t wait_time = cur_tick_ * tick_time_ - now;
+    return wait_time > 0 ? static_cast<int>(wait_time) : 0;
+}
+
+void MNetTimeoutWheel::Add(MNetConnector *p_connector)
+{
+    int64_t tick = p_connector->timeout_deadline_ / tick_time_;
+    if (tick < cur_tick_)
+    {
+        tick = cur_tick_;
+    }
+    MNetConnector **pp_slot = &slots_[tick & MNET_TIMEOUT_WHEEL_MASK];
+    p_connector->p_timeout_next_ = *pp_slot;
+    if (p_connector->p_timeout_next_)
+    {
+        p_connector->p_timeout_next_->pp_timeout_prev_ = &p_connector->p_timeout_next_;
+    }
+    p_connector->pp_timeout_prev_ = pp_slot;
+    *pp_slot = p_connector;
+    ++count_;
+}
+
+void MNetTimeoutWheel::Del(MNetConnector *p_connector)
+{
+    MNetConnector **pp_prev = p_connector->pp_timeout_prev_;
+    if (!pp_prev)
+    {
+        return;
+    }
+    *pp_prev = p_connector->p_timeout_next_;
+    if (p_connector->p_timeout_next_)
+    {
+        p_connector->p_timeout_next_->pp_timeout_prev_ = pp_prev;
+    }
+    p_connector->p_timeout_next_ = nullptr;
+    p_connector->pp_timeout_prev_ = nullptr;
+    --count_;
+}
+
+size_t MNetTimeoutWheel::Expire(int64_t now)
+{
+    size_t expired = 0;
+    int64_t now_tick = now / tick_time_;
+    if (now_tick - cur_tick_ >= MNET_TIMEOUT_WHEEL_SIZE)
+    {
+        cur_tick_ = now_tick - MNET_TIMEOUT_WHEEL_SIZE + 1;
+    }
+    while (cur_tick_ <= now_tick && count_ > 0)
+    {
+        MNetConnector *p_head = slots_[cur_tick_ & MNET_TIMEOUT_WHEEL_MASK];
+        slots_[cur_tick_ & MNET_TIMEOUT_WHEEL_MASK] = nullptr;
+        ++cur_tick_;
+        if (!p_head)
+        {
+            continue;
+        }
+        //callbacks may free any connector of the detached list
+        p_head->pp_timeout_prev_ = &p_head;
+        while (p_head)
+        {
+            MNetConnector *p_connector = p_head;
+            Del(p_connector);
+            if (p_connector->timeout_deadline_ > now)
+            {
+                Add(p_connector);
+                continue;
+            }
+            p_connector->OnTimeoutCallback(now);
+            ++expired;
+        }
+    }
+    if (cur_tick_ <= now_tick)
+    {
+        cur_tick_ = now_tick + 1;
+    }
+    return expired;
+}
@@ -0,0 +1,41 @@
+#ifndef _M_NET_TIMEOUT_WHEEL_H_
+#define _M_NET_TIMEOUT_WHEEL_H_
+
+#include <util/m_type_define.h>
+#include <cstddef>
+
+class MNetConnector;
+
+#define MNET_TIMEOUT_WHEEL_BITS 9
+#define MNET_TIMEOUT_WHEEL_SIZE (1 << MNET_TIMEOUT_WHEEL_BITS)
+#define MNET_TIMEOUT_WHEEL_MASK (MNET_TIMEOUT_WHEEL_SIZE - 1)
+#define MNET_TIMEOUT_WHEEL_TICK 100
+
+//coarse hashed wheel, deadlines further than one round stay in their slot until due
+class MNetTimeoutWheel
+{
+public:
+    MNetTimeoutWheel();
+    ~MNetTimeoutWheel();
+    MNetTimeoutWheel(const MNetTimeoutWheel &) = delete;
+    MNetTimeoutWheel& operator=(const MNetTimeoutWheel &) = delete;
+public:
+    void Init(int64_t now, int64_t tick_time = MNET_TIMEOUT_WHEEL_TICK);
+    void Clear();
+    bool Empty() const;
+    size_t GetCount() const;
+    int64_t GetTickTime() const;
+    //milliseconds until the next tick, -1 if nothing to wait
+    int GetWaitTime(int64_t now) const;
+
+    void Add(MNetConnector *p_connector);
+    void Del(MNetConnector *p_connector);
+    size_t Expire(int64_t now);
+private:
+    int64_t tick_time_;
+    int64_t cur_tick_;
+    size_t count_;
+    MNetConnector *slots_[MNET_TIMEOUT_WHEEL_SIZE];
+};
+
+#endif
@@ -3,7 +3,9 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <netinet/tcp.h>
 #include <util/m_logger.h>
+#include <util/m_object_pool.h>
 
 MSocket::MSocket(int sock)
     :sock_(sock)
@@ -17,6 +19,16 @@ MSocket::~MSocket()
     Close();
 }
 
+void* MSocket::operator new(size_t size)
+{
+    return MObjectPool<MSocket>::Alloc(size);
+}
+
+void MSocket::operator delete(void *p, size_t size)
+{
+    MObjectPool<MSocket>::Free(p, size);
+}
+
 MError MSocket::Attach(int sock)
 {
     if (sock_ != sock)
@@ -104,12 +116,24 @@ MError MSocket::Listen(int backlog)
 
 MError MSocket::Accept(MSocket &sock)
 {
+    int fd = -1;
     struct sockaddr_in addr;
+    MError err = AcceptNonblock(fd, addr);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    return sock.AttachAccepted(fd, addr);
+}
+
+MError MSocket::AcceptNonblock(int &fd, sockaddr_in &addr)
+{
     socklen_t len = sizeof(addr);
-    int fd = accept(sock_, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    fd = accept4(sock_, reinterpret_cast<struct sockaddr*>(&addr), &len, SOCK_NONBLOCK|SOCK_CLOEXEC);
     if (fd == -1)
     {
-        if (errno == EINTR)
+        //the peer reset before it was accepted, try the next one
+        if (errno == EINTR || errno == ECONNABORTED)
         {
             return MError::InterruptedSysCall;
         }
@@ -117,18 +141,47 @@ MError MSocket::Accept(MSocket &sock)
         {
             return MError::Again;
         }
+        else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+        {
+            MLOG(MGetLibLogger(), MERR, "errno is ", errno);
+            return MError::OutOfMemory;
+        }
         MLOG(MGetLibLogger(), MERR, "errno is ", errno);
         return MError::Unknown;
     }
-    MError err = sock.Attach(fd);
+    return MError::No;
+}
+
+MError MSocket::AttachAccepted(int fd, const sockaddr_in &addr)
+{
+    MError err = Attach(fd);
     if (err != MError::No)
     {
         close(fd);
         return err;
     }
-    sock.remote_ip_.resize(64);
-    inet_ntop(AF_INET, &addr.sin_addr.s_addr, &((sock.remote_ip_)[0]), sock.remote_ip_.size());
-    sock.remote_port_ = ntohs(addr.sin_port);
+    char ip[INET_ADDRSTRLEN];
+    if (!inet_ntop(AF_INET, &addr.sin_addr.s_addr, ip, sizeof(ip)))
+    {
+        ip[0] = '\0';
+    }
+    remote_ip_ = ip;
+    remote_port_ = ntohs(addr.sin_port);
+    return MError::No;
+}
+
+MError MSocket::GetAcceptQueue(unsigned &queue_len, unsigned &backlog) const
+{
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+    if (getsockopt(sock_, IPPROTO_TCP, TCP_INFO, &info, &len) == -1)
+    {
+        MLOG(MGetLibLogger(), MERR, "errno is ", errno);
+        return MError::Unknown;
+    }
+    //for a listener the kernel reports the accept queue in these two fields
+    queue_len = info.tcpi_unacked;
+    backlog = info.tcpi_sacked;
     return MError::No;
 }
 
@@ -202,6 +255,48 @@ std::pair<int, MError> MSocket::Recv(void *p_buf, int len)
     return std::make_pair(recv_len, MError::No);
 }
 
+std::pair<int, MError> MSocket::Writev(const iovec *p_iov, int count)
+{
+    if (count <= 0)
+    {
+        return std::make_pair(0, MError::No);
+    }
+    ssize_t send_len = writev(sock_, p_iov, count);
+    if (send_len == -1)
+    {
+        if (errno == EINTR)
+        {
+            return std::make_pair(0, MError::InterruptedSysCall);
+        }
+        else if (errno == EAGAIN)
+        {
+            return std::make_pair(0, MError::Again);
+        }
+        MLOG(MGetLibLogger(), MERR, "errno is ", errno);
+        return std::make_pair(0, MError::Unknown);
+    }
+    return std::make_pair(static_cast<int>(send_len), MError::No);
+}
+
+std::pair<int, MError> MSocket::Readv(const iovec *p_iov, int count)
+{
+    ssize_t recv_len = readv(sock_, p_iov, count);
+    if (recv_len == -1)
+    {
+        if (errno == EINTR)
+        {
+            return std::make_pair(0, MError::InterruptedSysCall);
+        }
+        else if (errno == EAGAIN)
+        {
+            return std::make_pair(0, MError::Again);
+        }
+        MLOG(MGetLibLogger(), MERR, "errno is ", errno);
+        return std::make_pair(0, MError::Unknown);
+    }
+    return std::make_pair(static_cast<int>(recv_len), MError::No);
+}
+
 MError MSocket::SetBlock(bool block)
 {
     int flag = fcntl(sock_, F_GETFL, 0);
@@ -238,6 +333,17 @@ MError MSocket::SetReUseAddr(bool re_use)
     return MError::No;
 }
 
+MError MSocket::SetReUsePort(bool re_use)
+{
+    int reuse = re_use ? 1 : 0;
+    if (setsockopt(sock_, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&reuse), sizeof(reuse)) < 0)
+    {
+        MLOG(MGetLibLogger(), MERR, "errno is ", errno);
+        return MError::Unknown;
+    }
+    return MError::No;
+}
+
 int MSocket::GetHandler() const
 {
     return sock_;
@@ -292,3 +398,38 @@ MError MSocket::CreateNonblockReuseAddrListener(const std::string &ip, unsigned
     }
     return MError::No;
 }
+
+MError MSocket::CreateNonblockReusePortListener(const std::string &ip, unsigned short port, int backlog)
+{
+    MError err = Create(MSocketFamily::IPV4, MSocketType::TCP, MSocketProtocol::Default);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = SetBlock(false);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = SetReUseAddr(true);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = SetReUsePort(true);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = Bind(ip, port);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    err = Listen(backlog);
+    if (err != MError::No)
+    {
+        return err;
+    }
+    return MError::No;
+}
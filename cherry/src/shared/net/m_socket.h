@@ -2,6 +2,7 @@
 #define _M_SOCKET_H_
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <string>
 #include <utility>
@@ -34,6 +35,9 @@ public:
     ~MSocket();
     MSocket(const MSocket &) = delete;
     MSocket& operator=(const MSocket &) = delete;
+    //allocated from MObjectPool<MSocket>
+    static void* operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 public:
     MError Attach(int sock);
     int Detach();
@@ -42,11 +46,19 @@ public:
     MError Bind(const std::string &ip, unsigned port);
     MError Listen(int backlog = 64);
     MError Accept(MSocket &sock);
+    //accept4 with SOCK_NONBLOCK|SOCK_CLOEXEC, fd is left to the caller
+    MError AcceptNonblock(int &fd, sockaddr_in &addr);
+    MError AttachAccepted(int fd, const sockaddr_in &addr);
+    //listening sockets only, pending connections and the backlog limit from TCP_INFO
+    MError GetAcceptQueue(unsigned &queue_len, unsigned &backlog) const;
     MError Connect(const std::string &ip, unsigned port);
     std::pair<int, MError> Send(const char *p_buf, int len);
     std::pair<int, MError> Recv(void *p_buf, int len);
+    std::pair<int, MError> Writev(const iovec *p_iov, int count);
+    std::pair<int, MError> Readv(const iovec *p_iov, int count);
     MError SetBlock(bool block);
     MError SetReUseAddr(bool re_use);
+    MError SetReUsePort(bool re_use);
     int GetHandler() const;
     const std::string& GetBindIP() const;
     unsigned GetBindPort() const;
@@ -54,6 +66,7 @@ public:
     unsigned GetRemotePort() const;
 public:
     MError CreateNonblockReuseAddrListener(const std::string &ip, unsigned short port, int backlog = 64);
+    MError CreateNonblockReusePortListener(const std::string &ip, unsigned short port, int backlog = 64);
 private:
     int sock_;
     std::string bind_ip_;
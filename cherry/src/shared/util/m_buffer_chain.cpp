@@ -0,0 +1,362 @@
+#include <util/m_buffer_chain.h>
+#include <util/m_object_pool.h>
+#include <cstring>
+#include <new>
+
+static char* GetWriteData(MBufferBlock *p_block)
+{
+    return reinterpret_cast<MBufferDataBlock*>(p_block)->data;
+}
+
+MBufferBlock* MBufferBlockPool::Alloc()
+{
+    MBufferDataBlock *p_data_block = static_cast<MBufferDataBlock*>(MObjectPool<MBufferDataBlock, MBUFFER_BLOCK_FREE_LIMIT>::Alloc());
+    MBufferBlock *p_block = &p_data_block->header;
+    p_block->p_next = nullptr;
+    p_block->start = 0;
+    p_block->end = 0;
+    p_block->capacity = MBUFFER_BLOCK_SIZE;
+    p_block->shared = false;
+    p_block->p_data = p_data_block->data;
+    return p_block;
+}
+
+MBufferBlock* MBufferBlockPool::AllocShared(const MSharedBuffer &buffer, size_t offset)
+{
+    MBufferSharedBlock *p_shared_block = static_cast<MBufferSharedBlock*>(MObjectPool<MBufferSharedBlock>::Alloc());
+    new (&p_shared_block->buffer) MSharedBuffer(buffer);
+    MBufferBlock *p_block = &p_shared_block->header;
+    p_block->p_next = nullptr;
+    p_block->start = offset;
+    p_block->end = buffer.GetLen();
+    p_block->capacity = p_block->end;
+    p_block->shared = true;
+    p_block->p_data = p_shared_block->buffer.GetData();
+    return p_block;
+}
+
+void MBufferBlockPool::Free(MBufferBlock *p_block)
+{
+    if (p_block->shared)
+    {
+        MBufferSharedBlock *p_shared_block = reinterpret_cast<MBufferSharedBlock*>(p_block);
+        p_shared_block->buffer.~MSharedBuffer();
+        MObjectPool<MBufferSharedBlock>::Free(p_shared_block);
+        return;
+    }
+    MObjectPool<MBufferDataBlock, MBUFFER_BLOCK_FREE_LIMIT>::Free(reinterpret_cast<MBufferDataBlock*>(p_block));
+}
+
+size_t MBufferBlockPool::GetFreeCount()
+{
+    return MObjectPool<MBufferDataBlock, MBUFFER_BLOCK_FREE_LIMIT>::GetCacheCount();
+}
+
+MObjectPoolStats MBufferBlockPool::GetStats()
+{
+    return MObjectPool<MBufferDataBlock, MBUFFER_BLOCK_FREE_LIMIT>::GetStats();
+}
+
+MBufferChain::MBufferChain(size_t max_len)
+    :p_head_(nullptr)
+    ,p_tail_(nullptr)
+    ,p_write_(nullptr)
+    ,p_reserve_tail_(nullptr)
+    ,reserving_(false)
+    ,len_(0)
+    ,max_len_(max_len)
+    ,block_count_(0)
+{
+}
+
+MBufferChain::~MBufferChain()
+{
+    Clear();
+}
+
+size_t MBufferChain::GetLen() const
+{
+    return len_;
+}
+
+bool MBufferChain::Empty() const
+{
+    return len_ == 0;
+}
+
+void MBufferChain::SetMaxLen(size_t max_len)
+{
+    max_len_ = max_len;
+}
+
+size_t MBufferChain::GetMaxLen() const
+{
+    return max_len_;
+}
+
+size_t MBufferChain::GetBlockCount() const
+{
+    return block_count_;
+}
+
+void MBufferChain::Clear()
+{
+    while (p_head_)
+    {
+        MBufferBlock *p_block = p_head_;
+        p_head_ = p_block->p_next;
+        MBufferBlockPool::Free(p_block);
+    }
+    p_tail_ = nullptr;
+    p_write_ = nullptr;
+    p_reserve_tail_ = nullptr;
+    reserving_ = false;
+    len_ = 0;
+    block_count_ = 0;
+}
+
+MBufferBlock* MBufferChain::PushBlock()
+{
+    MBufferBlock *p_block = MBufferBlockPool::Alloc();
+    LinkBlock(p_block);
+    return p_block;
+}
+
+void MBufferChain::LinkBlock(MBufferBlock *p_block)
+{
+    if (p_tail_)
+    {
+        p_tail_->p_next = p_block;
+    }
+    else
+    {
+        p_head_ = p_block;
+    }
+    p_tail_ = p_block;
+    ++block_count_;
+}
+
+bool MBufferChain::Append(const char *p_buf, size_t len)
+{
+    if (max_len_ > 0 && len > max_len_ - len_)
+    {
+        return false;
+    }
+    while (len > 0)
+    {
+        MBufferBlock *p_block = p_tail_;
+        if (!p_block || p_block->end == p_block->capacity)
+        {
+            p_block = PushBlock();
+        }
+        size_t copy_len = p_block->capacity - p_block->end;
+        if (copy_len > len)
+        {
+            copy_len = len;
+        }
+        memcpy(GetWriteData(p_block) + p_block->end, p_buf, copy_len);
+        p_block->end += copy_len;
+        p_buf += copy_len;
+        len -= copy_len;
+        len_ += copy_len;
+    }
+    return true;
+}
+
+bool MBufferChain::AppendShared(const MSharedBuffer &buffer, size_t offset)
+{
+    if (offset >= buffer.GetLen())
+    {
+        return offset == buffer.GetLen();
+    }
+    size_t len = buffer.GetLen() - offset;
+    if (max_len_ > 0 && len > max_len_ - len_)
+    {
+        return false;
+    }
+    LinkBlock(MBufferBlockPool::AllocShared(buffer, offset));
+    len_ += len;
+    return true;
+}
+
+bool MBufferChain::Peek(void *p_buf, size_t len) const
+{
+    if (len > len_)
+    {
+        return false;
+    }
+    char *p_dst = static_cast<char*>(p_buf);
+    for (MBufferBlock *p_block = p_head_; len > 0; p_block = p_block->p_next)
+    {
+        size_t copy_len = p_block->end - p_block->start;
+        if (copy_len > len)
+        {
+            copy_len = len;
+        }
+        memcpy(p_dst, p_block->p_data + p_block->start, copy_len);
+        p_dst += copy_len;
+        len -= copy_len;
+    }
+    return true;
+}
+
+bool MBufferChain::Read(void *p_buf, size_t len)
+{
+    if (!Peek(p_buf, len))
+    {
+        return false;
+    }
+    return Drain(len);
+}
+
+bool MBufferChain::Drain(size_t len)
+{
+    if (len > len_)
+    {
+        return false;
+    }
+    len_ -= len;
+    while (len > 0)
+    {
+        MBufferBlock *p_block = p_head_;
+        size_t block_len = p_block->end - p_block->start;
+        if (len < block_len)
+        {
+            p_block->start += len;
+            break;
+        }
+        len -= block_len;
+        p_head_ = p_block->p_next;
+        MBufferBlockPool::Free(p_block);
+        --block_count_;
+    }
+    if (!p_head_)
+    {
+        p_tail_ = nullptr;
+    }
+    return true;
+}
+
+const char* MBufferChain::GetContiguous(size_t offset, size_t len) const
+{
+    if (offset + len > len_)
+    {
+        return nullptr;
+    }
+    for (MBufferBlock *p_block = p_head_; p_block; p_block = p_block->p_next)
+    {
+        size_t block_len = p_block->end - p_block->start;
+        if (offset < block_len)
+        {
+            if (len > block_len - offset)
+            {
+                return nullptr;
+            }
+            return p_block->p_data + p_block->start + offset;
+        }
+        offset -= block_len;
+    }
+    return nullptr;
+}
+
+int MBufferChain::GetDataIov(iovec *p_iov, int max_iov) const
+{
+    int count = 0;
+    for (MBufferBlock *p_block = p_head_; p_block && count < max_iov; p_block = p_block->p_next)
+    {
+        if (p_block->end == p_block->start)
+        {
+            continue;
+        }
+        p_iov[count].iov_base = const_cast<char*>(p_block->p_data) + p_block->start;
+        p_iov[count].iov_len = p_block->end - p_block->start;
+        ++count;
+    }
+    return count;
+}
+
+int MBufferChain::GetCapacityIov(iovec *p_iov, int max_iov)
+{
+    size_t capacity = max_len_ > 0 ? max_len_ - len_ : static_cast<size_t>(-1);
+    p_reserve_tail_ = p_tail_;
+    p_write_ = p_tail_ && p_tail_->end < p_tail_->capacity ? p_tail_ : nullptr;
+    reserving_ = true;
+    int count = 0;
+    MBufferBlock *p_block = p_write_;
+    while (count < max_iov && capacity > 0)
+    {
+        if (!p_block)
+        {
+            p_block = PushBlock();
+            if (!p_write_)
+            {
+                p_write_ = p_block;
+            }
+        }
+        size_t block_capacity = p_block->capacity - p_block->end;
+        if (block_capacity > capacity)
+        {
+            block_capacity = capacity;
+        }
+        p_iov[count].iov_base = GetWriteData(p_block) + p_block->end;
+        p_iov[count].iov_len = block_capacity;
+        capacity -= block_capacity;
+        ++count;
+        p_block = nullptr;
+    }
+    return count;
+}
+
+bool MBufferChain::AddEndLen(size_t len)
+{
+    if (!reserving_)
+    {
+        return len == 0;
+    }
+    MBufferBlock *p_block = p_write_;
+    while (len > 0 && p_block)
+    {
+        size_t block_capacity = p_block->capacity - p_block->end;
+        if (block_capacity > len)
+        {
+            block_capacity = len;
+        }
+        p_block->end += block_capacity;
+        len_ += block_capacity;
+        len -= block_capacity;
+        p_block = p_block->p_next;
+    }
+    ReleaseReserved();
+    return len == 0;
+}
+
+//drop the blocks reserved by GetCapacityIov that the read did not reach
+void MBufferChain::ReleaseReserved()
+{
+    MBufferBlock *p_last = p_reserve_tail_;
+    MBufferBlock *p_block = p_last ? p_last->p_next : p_head_;
+    while (p_block && p_block->end > 0)
+    {
+        p_last = p_block;
+        p_block = p_block->p_next;
+    }
+    if (p_last)
+    {
+        p_last->p_next = nullptr;
+    }
+    else
+    {
+        p_head_ = nullptr;
+    }
+    p_tail_ = p_last;
+    while (p_block)
+    {
+        MBufferBlock *p_next = p_block->p_next;
+        MBufferBlockPool::Free(p_block);
+        --block_count_;
+        p_block = p_next;
+    }
+    p_reserve_tail_ = nullptr;
+    p_write_ = nullptr;
+    reserving_ = false;
+}
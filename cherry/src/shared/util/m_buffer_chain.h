@@ -0,0 +1,94 @@
+#ifndef _M_BUFFER_CHAIN_H_
+#define _M_BUFFER_CHAIN_H_
+
+#include <util/m_shared_buffer.h>
+#include <cstddef>
+#include <sys/uio.h>
+
+struct MObjectPoolStats;
+
+#define MBUFFER_BLOCK_SIZE       4096
+#define MBUFFER_BLOCK_FREE_LIMIT 1024
+
+//header of a queued segment, data points into a pooled block or into a referenced MSharedBuffer
+struct MBufferBlock
+{
+    MBufferBlock *p_next;
+    size_t start;
+    size_t end;
+    //a shared segment is full from the start and never written
+    size_t capacity;
+    bool shared;
+    const char *p_data;
+};
+
+struct MBufferDataBlock
+{
+    MBufferBlock header;
+    char data[MBUFFER_BLOCK_SIZE];
+};
+
+struct MBufferSharedBlock
+{
+    MBufferBlock header;
+    MSharedBuffer buffer;
+};
+
+//MObjectPool of data and shared blocks, up to MBUFFER_BLOCK_FREE_LIMIT data blocks cached per thread
+class MBufferBlockPool
+{
+public:
+    static MBufferBlock* Alloc();
+    //references buffer from offset on instead of copying it
+    static MBufferBlock* AllocShared(const MSharedBuffer &buffer, size_t offset);
+    static void Free(MBufferBlock *p_block);
+    static size_t GetFreeCount();
+    static MObjectPoolStats GetStats();
+};
+
+//segmented byte queue, max_len 0 means unbounded
+class MBufferChain
+{
+public:
+    explicit MBufferChain(size_t max_len = 0);
+    ~MBufferChain();
+    MBufferChain(const MBufferChain &) = delete;
+    MBufferChain& operator=(const MBufferChain &) = delete;
+public:
+    size_t GetLen() const;
+    bool Empty() const;
+    void SetMaxLen(size_t max_len);
+    size_t GetMaxLen() const;
+    size_t GetBlockCount() const;
+    void Clear();
+
+    bool Append(const char *p_buf, size_t len);
+    //queues a reference to buffer from offset on, the bytes are not copied
+    bool AppendShared(const MSharedBuffer &buffer, size_t offset = 0);
+    bool Peek(void *p_buf, size_t len) const;
+    bool Read(void *p_buf, size_t len);
+    bool Drain(size_t len);
+    //view of [offset, offset+len) when it lies in one block, nullptr otherwise
+    const char* GetContiguous(size_t offset, size_t len) const;
+
+    //queued data for writev, call Drain with the written length
+    int GetDataIov(iovec *p_iov, int max_iov) const;
+    //free space for readv, call AddEndLen with the read length, 0 when nothing was read
+    int GetCapacityIov(iovec *p_iov, int max_iov);
+    bool AddEndLen(size_t len);
+private:
+    MBufferBlock* PushBlock();
+    void LinkBlock(MBufferBlock *p_block);
+    void ReleaseReserved();
+private:
+    MBufferBlock *p_head_;
+    MBufferBlock *p_tail_;
+    MBufferBlock *p_write_;
+    MBufferBlock *p_reserve_tail_;
+    bool reserving_;
+    size_t len_;
+    size_t max_len_;
+    size_t block_count_;
+};
+
+#endif
@@ -23,6 +23,7 @@ enum class MError
     Invalid = 15,
     Underflow = 16,
     Overflow = 17,
+    Timeout = 18,
 };
 
 #endif
@@ -0,0 +1,111 @@
+#include <util/m_histogram.h>
+#include <cstring>
+
+MHistogram::MHistogram()
+{
+    Reset();
+}
+
+MHistogram::~MHistogram()
+{
+}
+
+void MHistogram::Record(int64_t value)
+{
+    ++buckets_[GetBucketIndex(value)];
+    if (count_ == 0 || value < min_)
+    {
+        min_ = value;
+    }
+    if (count_ == 0 || value > max_)
+    {
+        max_ = value;
+    }
+    ++count_;
+    sum_ += value;
+}
+
+void MHistogram::Reset()
+{
+    memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    sum_ = 0;
+    min_ = 0;
+    max_ = 0;
+}
+
+uint64_t MHistogram::GetCount() const
+{
+    return count_;
+}
+
+int64_t MHistogram::GetSum() const
+{
+    return sum_;
+}
+
+int64_t MHistogram::GetMin() const
+{
+    return min_;
+}
+
+int64_t MHistogram::GetMax() const
+{
+    return max_;
+}
+
+int64_t MHistogram::GetMean() const
+{
+    return count_ == 0 ? 0 : sum_ / static_cast<int64_t>(count_);
+}
+
+int64_t MHistogram::GetPercentile(double percent) const
+{
+    if (count_ == 0)
+    {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(count_ * percent / 100.0);
+    if (target >= count_)
+    {
+        target = count_ - 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < MHISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        seen += buckets_[i];
+        if (seen > target)
+        {
+            int64_t bound = GetBucketUpperBound(i);
+            return bound < max_ ? bound : max_;
+        }
+    }
+    return max_;
+}
+
+uint64_t MHistogram::GetBucketCount(size_t index) const
+{
+    return index < MHISTOGRAM_BUCKET_COUNT ? buckets_[index] : 0;
+}
+
+int64_t MHistogram::GetBucketUpperBound(size_t index)
+{
+    if (index == 0)
+    {
+        return 0;
+    }
+    if (index >= MHISTOGRAM_BUCKET_COUNT - 1)
+    {
+        return INT64_MAX;
+    }
+    return (static_cast<int64_t>(1) << index) - 1;
+}
+
+size_t MHistogram::GetBucketIndex(int64_t value)
+{
+    if (value <= 0)
+    {
+        return 0;
+    }
+    return 64 - __builtin_clzll(static_cast<uint64_t>(value));
+}
@@ -0,0 +1,37 @@
+#ifndef _M_HISTOGRAM_H_
+#define _M_HISTOGRAM_H_
+
+#include <util/m_type_define.h>
+#include <cstddef>
+
+#define MHISTOGRAM_BUCKET_COUNT 64
+
+class MHistogram
+{
+public:
+    MHistogram();
+    ~MHistogram();
+    MHistogram(const MHistogram &) = default;
+    MHistogram& operator=(const MHistogram &) = default;
+public:
+    void Record(int64_t value);
+    void Reset();
+    uint64_t GetCount() const;
+    int64_t GetSum() const;
+    int64_t GetMin() const;
+    int64_t GetMax() const;
+    int64_t GetMean() const;
+    int64_t GetPercentile(double percent) const;
+    uint64_t GetBucketCount(size_t index) const;
+    static int64_t GetBucketUpperBound(size_t index);
+private:
+    static size_t GetBucketIndex(int64_t value);
+private:
+    uint64_t buckets_[MHISTOGRAM_BUCKET_COUNT];
+    uint64_t count_;
+    int64_t sum_;
+    int64_t min_;
+    int64_t max_;
+};
+
+#endif
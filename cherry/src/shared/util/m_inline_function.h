@@ -0,0 +1,199 @@
+#ifndef _M_INLINE_FUNCTION_H_
+#define _M_INLINE_FUNCTION_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#define MINLINE_FUNCTION_CAPACITY 48
+
+template<typename R, typename ...Args>
+struct MInlineFunctionOps
+{
+    R (*invoke)(void *p_storage, Args&&... args);
+    void (*move)(void *p_dst, void *p_src);
+    void (*destroy)(void *p_storage);
+};
+
+template<typename F, bool Inline, typename R, typename ...Args>
+struct MInlineFunctionImpl;
+
+template<typename F, typename R, typename ...Args>
+struct MInlineFunctionImpl<F, true, R, Args...>
+{
+    static R Invoke(void *p_storage, Args&&... args)
+    {
+        return (*static_cast<F*>(p_storage))(std::forward<Args>(args)...);
+    }
+    static void Move(void *p_dst, void *p_src)
+    {
+        new (p_dst) F(std::move(*static_cast<F*>(p_src)));
+        static_cast<F*>(p_src)->~F();
+    }
+    static void Destroy(void *p_storage)
+    {
+        static_cast<F*>(p_storage)->~F();
+    }
+    static const MInlineFunctionOps<R, Args...> ops;
+};
+
+template<typename F, typename R, typename ...Args>
+const MInlineFunctionOps<R, Args...> MInlineFunctionImpl<F, true, R, Args...>::ops =
+{
+    &MInlineFunctionImpl<F, true, R, Args...>::Invoke,
+    &MInlineFunctionImpl<F, true, R, Args...>::Move,
+    &MInlineFunctionImpl<F, true, R, Args...>::Destroy,
+};
+
+//callables that do not fit the inline buffer are kept on the heap
+template<typename F, typename R, typename ...Args>
+struct MInlineFunctionImpl<F, false, R, Args...>
+{
+    static R Invoke(void *p_storage, Args&&... args)
+    {
+        return (**static_cast<F**>(p_storage))(std::forward<Args>(args)...);
+    }
+    static void Move(void *p_dst, void *p_src)
+    {
+        *static_cast<F**>(p_dst) = *static_cast<F**>(p_src);
+    }
+    static void Destroy(void *p_storage)
+    {
+        delete *static_cast<F**>(p_storage);
+    }
+    static const MInlineFunctionOps<R, Args...> ops;
+};
+
+template<typename F, typename R, typename ...Args>
+const MInlineFunctionOps<R, Args...> MInlineFunctionImpl<F, false, R, Args...>::ops =
+{
+    &MInlineFunctionImpl<F, false, R, Args...>::Invoke,
+    &MInlineFunctionImpl<F, false, R, Args...>::Move,
+    &MInlineFunctionImpl<F, false, R, Args...>::Destroy,
+};
+
+template<typename Signature, size_t Capacity = MINLINE_FUNCTION_CAPACITY>
+class MInlineFunction;
+
+template<typename R, typename ...Args, size_t Capacity>
+class MInlineFunction<R (Args...), Capacity>
+{
+    template<typename F>
+    struct MIsInline
+    {
+        static const bool value = sizeof(F) <= Capacity
+            && alignof(F) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<F>::value;
+    };
+public:
+    MInlineFunction()
+        :p_ops_(nullptr)
+    {
+    }
+    MInlineFunction(std::nullptr_t)
+        :p_ops_(nullptr)
+    {
+    }
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, MInlineFunction>::value>::type>
+    MInlineFunction(F &&f)
+        :p_ops_(nullptr)
+    {
+        Assign(std::forward<F>(f));
+    }
+    ~MInlineFunction()
+    {
+        Reset();
+    }
+    MInlineFunction(MInlineFunction &&other) noexcept
+        :p_ops_(other.p_ops_)
+    {
+        if (p_ops_)
+        {
+            p_ops_->move(&storage_, &other.storage_);
+            other.p_ops_ = nullptr;
+        }
+    }
+    MInlineFunction& operator=(MInlineFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            p_ops_ = other.p_ops_;
+            if (p_ops_)
+            {
+                p_ops_->move(&storage_, &other.storage_);
+                other.p_ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+    MInlineFunction& operator=(std::nullptr_t)
+    {
+        Reset();
+        return *this;
+    }
+    MInlineFunction(const MInlineFunction &) = delete;
+    MInlineFunction& operator=(const MInlineFunction &) = delete;
+public:
+    explicit operator bool() const
+    {
+        return p_ops_ != nullptr;
+    }
+    R operator()(Args... args) const
+    {
+        return p_ops_->invoke(&storage_, std::forward<Args>(args)...);
+    }
+    void Reset()
+    {
+        if (p_ops_)
+        {
+            p_ops_->destroy(&storage_);
+            p_ops_ = nullptr;
+        }
+    }
+private:
+    template<typename F>
+    static bool IsNull(const F &)
+    {
+        return false;
+    }
+    template<typename T>
+    static bool IsNull(T *p)
+    {
+        return !p;
+    }
+    template<typename Sig>
+    static bool IsNull(const std::function<Sig> &f)
+    {
+        return !f;
+    }
+    template<typename F>
+    void Assign(F &&f)
+    {
+        typedef typename std::decay<F>::type Func;
+        if (IsNull(f))
+        {
+            return;
+        }
+        Construct<Func>(std::forward<F>(f), std::integral_constant<bool, MIsInline<Func>::value>());
+        p_ops_ = &MInlineFunctionImpl<Func, MIsInline<Func>::value, R, Args...>::ops;
+    }
+    template<typename Func, typename F>
+    void Construct(F &&f, std::true_type)
+    {
+        new (&storage_) Func(std::forward<F>(f));
+    }
+    template<typename Func, typename F>
+    void Construct(F &&f, std::false_type)
+    {
+        *reinterpret_cast<Func**>(&storage_) = new Func(std::forward<F>(f));
+    }
+private:
+    const MInlineFunctionOps<R, Args...> *p_ops_;
+    mutable typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type storage_;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef _M_MPSC_QUEUE_H_
+#define _M_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#define MMPSC_QUEUE_NODE_CACHE 256
+
+template<typename T>
+class MMpscQueue
+{
+    struct MMpscNode
+    {
+        MMpscNode()
+            :next(nullptr)
+        {
+        }
+        std::atomic<MMpscNode*> next;
+        T value;
+    };
+    struct MNodeCache
+    {
+        ~MNodeCache()
+        {
+            while (p_head)
+            {
+                MMpscNode *p_node = p_head;
+                p_head = p_node->next.load(std::memory_order_relaxed);
+                delete p_node;
+            }
+        }
+        MMpscNode *p_head = nullptr;
+        size_t count = 0;
+    };
+    struct MNodeBatch
+    {
+        ~MNodeBatch()
+        {
+            MMpscNode *p_node = p_head.exchange(nullptr, std::memory_order_acquire);
+            while (p_node)
+            {
+                MMpscNode *p_next = p_node->next.load(std::memory_order_relaxed);
+                delete p_node;
+                p_node = p_next;
+            }
+        }
+        std::atomic<MMpscNode*> p_head{nullptr};
+    };
+public:
+    MMpscQueue()
+        :head_(&stub_)
+        ,p_tail_(&stub_)
+    {
+    }
+    ~MMpscQueue()
+    {
+        T value;
+        while (Pop(value))
+        {
+        }
+    }
+    MMpscQueue(const MMpscQueue &) = delete;
+    MMpscQueue& operator=(const MMpscQueue &) = delete;
+public:
+    void Push(const T &value)
+    {
+        MMpscNode *p_node = AllocNode();
+        p_node->value = value;
+        Link(p_node, p_node);
+    }
+    void Push(T &&value)
+    {
+        MMpscNode *p_node = AllocNode();
+        p_node->value = std::move(value);
+        Link(p_node, p_node);
+    }
+    template<typename Iter>
+    void PushBatch(Iter first, Iter last)
+    {
+        if (first == last)
+        {
+            return;
+        }
+        MMpscNode *p_first = AllocNode();
+        p_first->value = *first;
+        MMpscNode *p_last = p_first;
+        for (++first; first != last; ++first)
+        {
+            MMpscNode *p_node = AllocNode();
+            p_node->value = *first;
+            p_last->next.store(p_node, std::memory_order_relaxed);
+            p_last = p_node;
+        }
+        Link(p_first, p_last);
+    }
+    //only the consumer thread
+    bool Pop(T &value)
+    {
+        MMpscNode *p_tail = p_tail_;
+        MMpscNode *p_next = p_tail->next.load(std::memory_order_acquire);
+        if (p_tail == &stub_)
+        {
+            if (!p_next)
+            {
+                return false;
+            }
+            p_tail_ = p_next;
+            p_tail = p_next;
+            p_next = p_next->next.load(std::memory_order_acquire);
+        }
+        if (!p_next)
+        {
+            if (p_tail != head_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            stub_.next.store(nullptr, std::memory_order_relaxed);
+            Link(&stub_, &stub_);
+            p_next = p_tail->next.load(std::memory_order_acquire);
+            if (!p_next)
+            {
+                return false;
+            }
+        }
+        p_tail_ = p_next;
+        value = std::move(p_tail->value);
+        FreeNode(p_tail);
+        return true;
+    }
+    bool Empty() const
+    {
+        return p_tail_ == &stub_
+            && stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+private:
+    //nodes are recycled through a per thread cache, a full consumer cache is handed
+    //to producers as one batch and taken whole with an exchange, so there is no ABA
+    static MNodeCache& GetNodeCache()
+    {
+        static thread_local MNodeCache cache;
+        return cache;
+    }
+    static std::atomic<MMpscNode*>& GetNodeBatch()
+    {
+        static MNodeBatch batch;
+        return batch.p_head;
+    }
+    static MMpscNode* AllocNode()
+    {
+        MNodeCache &cache = GetNodeCache();
+        if (!cache.p_head)
+        {
+            cache.p_head = GetNodeBatch().exchange(nullptr, std::memory_order_acquire);
+            if (!cache.p_head)
+            {
+                return new MMpscNode();
+            }
+            cache.count = MMPSC_QUEUE_NODE_CACHE;
+        }
+        MMpscNode *p_node = cache.p_head;
+        cache.p_head = p_node->next.load(std::memory_order_relaxed);
+        --cache.count;
+        p_node->next.store(nullptr, std::memory_order_relaxed);
+        return p_node;
+    }
+    static void FreeNode(MMpscNode *p_node)
+    {
+        p_node->value = T();
+        MNodeCache &cache = GetNodeCache();
+        if (cache.count >= MMPSC_QUEUE_NODE_CACHE)
+        {
+            MMpscNode *p_expected = nullptr;
+            if (!GetNodeBatch().compare_exchange_strong(p_expected, cache.p_head
+                , std::memory_order_release, std::memory_order_relaxed))
+            {
+                delete p_node;
+                return;
+            }
+            cache.p_head = nullptr;
+            cache.count = 0;
+        }
+        p_node->next.store(cache.p_head, std::memory_order_relaxed);
+        cache.p_head = p_node;
+        ++cache.count;
+    }
+    void Link(MMpscNode *p_first, MMpscNode *p_last)
+    {
+        MMpscNode *p_prev = head_.exchange(p_last, std::memory_order_acq_rel);
+        p_prev->next.store(p_first, std::memory_order_release);
+    }
+private:
+    std::atomic<MMpscNode*> head_;
+    MMpscNode *p_tail_;
+    MMpscNode stub_;
+};
+
+#endif
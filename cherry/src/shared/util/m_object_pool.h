@@ -0,0 +1,224 @@
+#ifndef _M_OBJECT_POOL_H_
+#define _M_OBJECT_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#define MOBJECT_POOL_CACHE_LIMIT    256
+#define MOBJECT_POOL_SHARED_BATCHES 8
+
+struct MObjectPoolStats
+{
+    uint64_t alloc_count;
+    //allocations served from a thread cache or a handed over batch
+    uint64_t hit_count;
+    uint64_t in_use;
+    uint64_t in_use_high_water;
+    //full caches handed to other threads, and frees returned to the system because the handoff was taken
+    uint64_t handoff_count;
+    uint64_t release_count;
+};
+
+//per type pool of fixed size memory, every thread keeps up to CacheLimit free objects
+//a thread that frees more than it allocates (e.g. one that only closes sessions) hands
+//its full cache to allocating threads through MOBJECT_POOL_SHARED_BATCHES shared slots,
+//each taken whole with an exchange so there is no ABA, and frees beyond that go back to the system
+template<typename T, size_t CacheLimit = MOBJECT_POOL_CACHE_LIMIT>
+class MObjectPool
+{
+    struct MFreeNode
+    {
+        MFreeNode *p_next;
+    };
+    //trivially destructible so it stays usable while other thread locals are destroyed
+    struct MFreeCache
+    {
+        MFreeNode *p_head;
+        size_t count;
+        bool closed;
+    };
+    struct MFreeCacheReleaser
+    {
+        ~MFreeCacheReleaser()
+        {
+            MFreeCache &cache = GetCache();
+            ReleaseList(cache.p_head);
+            cache.p_head = nullptr;
+            cache.count = 0;
+            cache.closed = true;
+        }
+    };
+    //never destroyed, objects may still be freed by static destructors at exit
+    struct MShared
+    {
+        std::atomic<MFreeNode*> p_batches[MOBJECT_POOL_SHARED_BATCHES] = {};
+        std::atomic<size_t> batch_count{0};
+        std::atomic<uint64_t> alloc_count{0};
+        std::atomic<uint64_t> hit_count{0};
+        std::atomic<uint64_t> in_use{0};
+        std::atomic<uint64_t> in_use_high_water{0};
+        std::atomic<uint64_t> handoff_count{0};
+        std::atomic<uint64_t> release_count{0};
+    };
+    static const size_t kObjectSize = sizeof(T) > sizeof(MFreeNode) ? sizeof(T) : sizeof(MFreeNode);
+public:
+    template<typename ...Args>
+    static T* Create(Args&&... args)
+    {
+        return new (Alloc()) T(std::forward<Args>(args)...);
+    }
+    static void Destroy(T *p)
+    {
+        if (p)
+        {
+            p->~T();
+            Free(p);
+        }
+    }
+    static void* Alloc()
+    {
+        MShared &shared = GetShared();
+        shared.alloc_count.fetch_add(1, std::memory_order_relaxed);
+        uint64_t in_use = shared.in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t high_water = shared.in_use_high_water.load(std::memory_order_relaxed);
+        while (in_use > high_water
+            && !shared.in_use_high_water.compare_exchange_weak(high_water, in_use, std::memory_order_relaxed))
+        {
+        }
+        MFreeCache &cache = GetCache();
+        if (!cache.p_head && !cache.closed && shared.batch_count.load(std::memory_order_relaxed) > 0)
+        {
+            for (auto &p_batch : shared.p_batches)
+            {
+                cache.p_head = p_batch.exchange(nullptr, std::memory_order_acquire);
+                if (cache.p_head)
+                {
+                    shared.batch_count.fetch_sub(1, std::memory_order_relaxed);
+                    cache.count = CacheLimit;
+                    break;
+                }
+            }
+        }
+        if (!cache.p_head)
+        {
+            return ::operator new(kObjectSize);
+        }
+        shared.hit_count.fetch_add(1, std::memory_order_relaxed);
+        MFreeNode *p_node = cache.p_head;
+        cache.p_head = p_node->p_next;
+        --cache.count;
+        return p_node;
+    }
+    static void Free(void *p)
+    {
+        MShared &shared = GetShared();
+        shared.in_use.fetch_sub(1, std::memory_order_relaxed);
+        MFreeCache &cache = GetCache();
+        if (cache.closed)
+        {
+            shared.release_count.fetch_add(1, std::memory_order_relaxed);
+            ::operator delete(p);
+            return;
+        }
+        if (cache.count >= CacheLimit)
+        {
+            if (!HandOff(cache.p_head))
+            {
+                shared.release_count.fetch_add(1, std::memory_order_relaxed);
+                ::operator delete(p);
+                return;
+            }
+            cache.p_head = nullptr;
+            cache.count = 0;
+        }
+        MFreeNode *p_node = static_cast<MFreeNode*>(p);
+        p_node->p_next = cache.p_head;
+        cache.p_head = p_node;
+        ++cache.count;
+    }
+    //for class operator new/delete, derived classes of another size bypass the pool
+    static void* Alloc(size_t size)
+    {
+        return size == sizeof(T) ? Alloc() : ::operator new(size);
+    }
+    static void Free(void *p, size_t size)
+    {
+        if (size == sizeof(T))
+        {
+            Free(p);
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+    //free objects cached by the calling thread
+    static size_t GetCacheCount()
+    {
+        return GetCache().count;
+    }
+    static MObjectPoolStats GetStats()
+    {
+        MShared &shared = GetShared();
+        MObjectPoolStats stats;
+        stats.alloc_count = shared.alloc_count.load(std::memory_order_relaxed);
+        stats.hit_count = shared.hit_count.load(std::memory_order_relaxed);
+        stats.in_use = shared.in_use.load(std::memory_order_relaxed);
+        stats.in_use_high_water = shared.in_use_high_water.load(std::memory_order_relaxed);
+        stats.handoff_count = shared.handoff_count.load(std::memory_order_relaxed);
+        stats.release_count = shared.release_count.load(std::memory_order_relaxed);
+        return stats;
+    }
+    static double GetHitRate()
+    {
+        MObjectPoolStats stats = GetStats();
+        return stats.alloc_count > 0 ? static_cast<double>(stats.hit_count) / stats.alloc_count : 0.0;
+    }
+private:
+    static MFreeCache& GetCache()
+    {
+        static thread_local MFreeCache cache = {nullptr, 0, false};
+        static thread_local MFreeCacheReleaser releaser;
+        (void)releaser;
+        return cache;
+    }
+    static MShared& GetShared()
+    {
+        static MShared shared;
+        return shared;
+    }
+    static bool HandOff(MFreeNode *p_head)
+    {
+        MShared &shared = GetShared();
+        if (shared.batch_count.load(std::memory_order_relaxed) >= MOBJECT_POOL_SHARED_BATCHES)
+        {
+            return false;
+        }
+        for (auto &p_batch : shared.p_batches)
+        {
+            MFreeNode *p_expected = nullptr;
+            if (p_batch.compare_exchange_strong(p_expected, p_head
+                , std::memory_order_release, std::memory_order_relaxed))
+            {
+                shared.batch_count.fetch_add(1, std::memory_order_relaxed);
+                shared.handoff_count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    static void ReleaseList(MFreeNode *p_node)
+    {
+        while (p_node)
+        {
+            MFreeNode *p_next = p_node->p_next;
+            ::operator delete(p_node);
+            p_node = p_next;
+        }
+    }
+};
+
+#endif
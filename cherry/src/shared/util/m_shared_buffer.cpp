@@ -0,0 +1,110 @@
+#include <util/m_shared_buffer.h>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+MSharedBuffer::MSharedBuffer()
+    :p_block_(nullptr)
+{
+}
+
+MSharedBuffer::MSharedBuffer(size_t len)
+    :p_block_(nullptr)
+{
+    void *p = malloc(offsetof(MSharedBlock, data) + len);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    p_block_ = static_cast<MSharedBlock*>(p);
+    new (&p_block_->ref_count) std::atomic<long>(1);
+    p_block_->len = len;
+}
+
+MSharedBuffer::MSharedBuffer(const char *p_buf, size_t len)
+    :MSharedBuffer(len)
+{
+    memcpy(p_block_->data, p_buf, len);
+}
+
+MSharedBuffer::~MSharedBuffer()
+{
+    Reset();
+}
+
+MSharedBuffer::MSharedBuffer(const MSharedBuffer &other)
+    :p_block_(other.p_block_)
+{
+    if (p_block_)
+    {
+        p_block_->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MSharedBuffer& MSharedBuffer::operator=(const MSharedBuffer &other)
+{
+    if (p_block_ != other.p_block_)
+    {
+        MSharedBuffer tmp(other);
+        std::swap(p_block_, tmp.p_block_);
+    }
+    return *this;
+}
+
+MSharedBuffer::MSharedBuffer(MSharedBuffer &&other) noexcept
+    :p_block_(other.p_block_)
+{
+    other.p_block_ = nullptr;
+}
+
+MSharedBuffer& MSharedBuffer::operator=(MSharedBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+        p_block_ = other.p_block_;
+        other.p_block_ = nullptr;
+    }
+    return *this;
+}
+
+const char* MSharedBuffer::GetData() const
+{
+    return p_block_ ? p_block_->data : nullptr;
+}
+
+size_t MSharedBuffer::GetLen() const
+{
+    return p_block_ ? p_block_->len : 0;
+}
+
+bool MSharedBuffer::Empty() const
+{
+    return GetLen() == 0;
+}
+
+long MSharedBuffer::GetRefCount() const
+{
+    return p_block_ ? p_block_->ref_count.load(std::memory_order_relaxed) : 0;
+}
+
+char* MSharedBuffer::GetWriteData()
+{
+    if (!p_block_ || p_block_->ref_count.load(std::memory_order_acquire) != 1)
+    {
+        return nullptr;
+    }
+    return p_block_->data;
+}
+
+void MSharedBuffer::Reset()
+{
+    if (p_block_ && p_block_->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        p_block_->ref_count.~atomic();
+        free(p_block_);
+    }
+    p_block_ = nullptr;
+}
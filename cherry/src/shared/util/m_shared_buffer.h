@@ -0,0 +1,37 @@
+#ifndef _M_SHARED_BUFFER_H_
+#define _M_SHARED_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+
+//refcounted byte buffer, filled through GetWriteData before it is shared and immutable after
+class MSharedBuffer
+{
+    struct MSharedBlock
+    {
+        std::atomic<long> ref_count;
+        size_t len;
+        char data[1];
+    };
+public:
+    MSharedBuffer();
+    explicit MSharedBuffer(size_t len);
+    MSharedBuffer(const char *p_buf, size_t len);
+    ~MSharedBuffer();
+    MSharedBuffer(const MSharedBuffer &other);
+    MSharedBuffer& operator=(const MSharedBuffer &other);
+    MSharedBuffer(MSharedBuffer &&other) noexcept;
+    MSharedBuffer& operator=(MSharedBuffer &&other) noexcept;
+public:
+    const char* GetData() const;
+    size_t GetLen() const;
+    bool Empty() const;
+    long GetRefCount() const;
+    //nullptr once the buffer is shared
+    char* GetWriteData();
+    void Reset();
+private:
+    MSharedBlock *p_block_;
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef _M_SLOT_MAP_H_
+#define _M_SLOT_MAP_H_
+
+#include <util/m_type_define.h>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//handle layout: owner:8 | slot:24 | generation:32, 0 is never a valid handle
+#define MSLOT_MAP_INVALID_HANDLE 0
+#define MSLOT_MAP_SLOT_BITS      24
+#define MSLOT_MAP_MAX_SLOT       ((1u << MSLOT_MAP_SLOT_BITS) - 1)
+#define MSLOT_MAP_MAX_OWNER      255
+
+//generational slot map, O(1) insert/get/remove and dense values for iteration
+//not thread safe, each map belongs to one thread and other threads route by GetOwner
+template<typename T>
+class MSlotMap
+{
+    struct MSlot
+    {
+        uint32_t index;//dense index while used, next free slot while free
+        uint32_t generation;
+    };
+public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+public:
+    MSlotMap()
+        :owner_(0)
+        ,free_head_(MSLOT_MAP_MAX_SLOT)
+    {
+    }
+    ~MSlotMap()
+    {
+    }
+    MSlotMap(const MSlotMap &) = delete;
+    MSlotMap& operator=(const MSlotMap &) = delete;
+public:
+    static uint8_t GetOwner(uint64_t handle)
+    {
+        return static_cast<uint8_t>(handle >> 56);
+    }
+    static uint32_t GetSlot(uint64_t handle)
+    {
+        return static_cast<uint32_t>(handle >> 32) & MSLOT_MAP_MAX_SLOT;
+    }
+    static uint32_t GetGeneration(uint64_t handle)
+    {
+        return static_cast<uint32_t>(handle);
+    }
+public:
+    void Init(uint8_t owner, size_t reserve_count = 0)
+    {
+        Clear();
+        owner_ = owner;
+        slots_.reserve(reserve_count);
+        values_.reserve(reserve_count);
+        value_slots_.reserve(reserve_count);
+    }
+    //handles from before Clear stay stale
+    void Clear()
+    {
+        while (!value_slots_.empty())
+        {
+            Release(value_slots_.back());
+        }
+    }
+    uint8_t GetOwner() const
+    {
+        return owner_;
+    }
+    size_t GetCount() const
+    {
+        return values_.size();
+    }
+    bool Empty() const
+    {
+        return values_.empty();
+    }
+    //returns MSLOT_MAP_INVALID_HANDLE when every slot is used
+    uint64_t Insert(T value)
+    {
+        uint32_t slot = free_head_;
+        if (slot != MSLOT_MAP_MAX_SLOT)
+        {
+            free_head_ = slots_[slot].index;
+        }
+        else
+        {
+            if (slots_.size() >= MSLOT_MAP_MAX_SLOT)
+            {
+                return MSLOT_MAP_INVALID_HANDLE;
+            }
+            slot = static_cast<uint32_t>(slots_.size());
+            MSlot new_slot;
+            new_slot.generation = 1;
+            slots_.push_back(new_slot);
+        }
+        slots_[slot].index = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        value_slots_.push_back(slot);
+        return (static_cast<uint64_t>(owner_) << 56)
+            | (static_cast<uint64_t>(slot) << 32)
+            | slots_[slot].generation;
+    }
+    //nullptr for stale handles and handles of other owners
+    T* Get(uint64_t handle)
+    {
+        uint32_t slot = Find(handle);
+        if (slot == MSLOT_MAP_MAX_SLOT)
+        {
+            return nullptr;
+        }
+        return &values_[slots_[slot].index];
+    }
+    const T* Get(uint64_t handle) const
+    {
+        return const_cast<MSlotMap*>(this)->Get(handle);
+    }
+    bool Contains(uint64_t handle) const
+    {
+        return Find(handle) != MSLOT_MAP_MAX_SLOT;
+    }
+    //moves the last value into the hole, iterators past it are invalidated
+    bool Remove(uint64_t handle)
+    {
+        uint32_t slot = Find(handle);
+        if (slot == MSLOT_MAP_MAX_SLOT)
+        {
+            return false;
+        }
+        Release(slot);
+        return true;
+    }
+    iterator begin()
+    {
+        return values_.begin();
+    }
+    iterator end()
+    {
+        return values_.end();
+    }
+    const_iterator begin() const
+    {
+        return values_.begin();
+    }
+    const_iterator end() const
+    {
+        return values_.end();
+    }
+private:
+    uint32_t Find(uint64_t handle) const
+    {
+        uint32_t slot = GetSlot(handle);
+        if (GetOwner(handle) != owner_
+            || slot >= slots_.size()
+            || slots_[slot].generation != GetGeneration(handle))
+        {
+            return MSLOT_MAP_MAX_SLOT;
+        }
+        return slot;
+    }
+    void Release(uint32_t slot)
+    {
+        uint32_t index = slots_[slot].index;
+        uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        if (index != last)
+        {
+            values_[index] = std::move(values_[last]);
+            value_slots_[index] = value_slots_[last];
+            slots_[value_slots_[index]].index = index;
+        }
+        values_.pop_back();
+        value_slots_.pop_back();
+        //generation 0 is skipped so a handle is never 0
+        if (++slots_[slot].generation == 0)
+        {
+            slots_[slot].generation = 1;
+        }
+        slots_[slot].index = free_head_;
+        free_head_ = slot;
+    }
+private:
+    uint8_t owner_;
+    uint32_t free_head_;
+    std::vector<MSlot> slots_;
+    std::vector<T> values_;
+    std::vector<uint32_t> value_slots_;
+};
+
+#endif
@@ -32,12 +32,17 @@ void MThread::Stop()
 
 MError MThread::Join()
 {
+    if (tid_ == 0)
+    {
+        return MError::No;
+    }
     int err = pthread_join(tid_, nullptr);
     if (err != 0)
     {
         MLOG(MGetLibLogger(), MERR, "join thread failed err:", err);
         return MError::Unknown;
     }
+    tid_ = 0;
     return MError::No;
 }
 
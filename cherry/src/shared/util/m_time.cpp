@@ -1,5 +1,6 @@
 #include <util/m_time.h>
 #include <sys/time.h>
+#include <time.h>
 
 int64_t MTime::GetTime()
 {
@@ -8,3 +9,16 @@ int64_t MTime::GetTime()
     return static_cast<int64_t>(tv.tv_sec) * 1000
         + static_cast<int64_t>(tv.tv_usec) / 1000;
 }
+
+int64_t MTime::GetMonotonicTime()
+{
+    return GetMonotonicNanoTime() / 1000000;
+}
+
+int64_t MTime::GetMonotonicNanoTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000
+        + static_cast<int64_t>(ts.tv_nsec);
+}
@@ -7,6 +7,8 @@ class MTime
 {
 public:
     static int64_t GetTime();
+    static int64_t GetMonotonicTime();
+    static int64_t GetMonotonicNanoTime();
 };
 
 #endif